@@ -0,0 +1,196 @@
+//this file contains compositing kernels used by surface::insertSurface()
+#pragma once
+#include "tui_symbol_grid.h"
+
+#if !defined(TUI_DISABLE_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define TUI_BLIT_SSE2
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+namespace tui
+{
+	namespace blit
+	{
+		//bits of colors, same as in COLOR_TRANSPARENCY
+		enum COLOR_BIT : uint8_t
+		{
+			BG = 0b1,
+			FG = 0b10
+		};
+
+		//transparency is taken from every source symbol
+		constexpr uint8_t SOURCE_TRANSPARENCY = 4;
+
+		/*copies count symbols from src starting at src_i to dst starting at dst_i,
+		C - colors replaced by c_fg / c_bg, T - transparency override or SOURCE_TRANSPARENCY,
+		changed_begin and changed_end are extended by range of modified symbols (relative to dst_i)*/
+		using kernel = void(*)(
+			symbol_grid& dst, size_t dst_i,
+			const symbol_grid& src, size_t src_i,
+			int count,
+			uint32_t c_fg, uint32_t c_bg,
+			int& changed_begin, int& changed_end
+		);
+
+		//processes symbols from begin to count
+		template<uint8_t C, uint8_t T>
+		void blitRowScalar(
+			symbol_grid& dst, size_t dst_i,
+			const symbol_grid& src, size_t src_i,
+			int begin, int count,
+			uint32_t c_fg, uint32_t c_bg,
+			int& changed_begin, int& changed_end
+		)
+		{
+			for (int i = begin; i < count; i++)
+			{
+				const size_t s = src_i + i;
+				const size_t d = dst_i + i;
+
+				const uint32_t glyph = src.glyphs[s];
+				if (glyph_table::isTransparent(glyph)) { continue; }//fully transparent, ignore
+
+				const uint8_t src_a = src.attributes[s];
+				const uint8_t dst_a = dst.attributes[d];
+				const uint8_t t = T == SOURCE_TRANSPARENCY ? src_a & symbol_grid::TRANSPARENCY_MASK : T;
+
+				symbol_grid::cell c;
+				c.glyph = glyph;
+				c.foreground = (t & FG) ? dst.foregrounds[d] : (C & FG) ? c_fg : src.foregrounds[s];
+				c.background = (t & BG) ? dst.backgrounds[d] : (C & BG) ? c_bg : src.backgrounds[s];
+				c.attributes = (src_a & ~symbol_grid::TRANSPARENCY_MASK) | (t & dst_a);
+
+				if (!dst.isEqual(d, c))
+				{
+					dst.setCell(d, c);
+					changed_begin = std::min(changed_begin, i);
+					changed_end = i + 1;
+				}
+			}
+		}
+
+#ifdef TUI_BLIT_SSE2
+		//mask ? a : b
+		inline __m128i select(__m128i mask, __m128i a, __m128i b)
+		{
+			return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+		}
+
+		//4 attribute bytes to 4 32bit lanes
+		inline __m128i widenAttributes(uint32_t a)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(a)), zero), zero);
+		}
+
+		/*processes blocks of 4 symbols, transparency has to be fixed(T != SOURCE_TRANSPARENCY),
+		returns number of processed symbols*/
+		template<uint8_t C, uint8_t T>
+		int blitRowSse2(
+			symbol_grid& dst, size_t dst_i,
+			const symbol_grid& src, size_t src_i,
+			int count,
+			uint32_t c_fg, uint32_t c_bg,
+			int& changed_begin, int& changed_end
+		)
+		{
+			const __m128i empty = _mm_set1_epi32(glyph_table::EMPTY);
+			const __m128i nul = _mm_set1_epi32(glyph_table::NUL);
+			const __m128i override_fg = _mm_set1_epi32(static_cast<int>(c_fg));
+			const __m128i override_bg = _mm_set1_epi32(static_cast<int>(c_bg));
+
+			//attributes of 4 symbols are processed as single 32bit word
+			const uint32_t keep_bits = 0x01010101u * static_cast<uint8_t>(~symbol_grid::TRANSPARENCY_MASK);
+			const uint32_t t_bits = 0x01010101u * (T & symbol_grid::TRANSPARENCY_MASK);
+
+			auto load = [](const uint32_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); };
+			auto store = [](uint32_t* p, __m128i v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); };
+
+			int i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				const size_t s = src_i + i;
+				const size_t d = dst_i + i;
+
+				const __m128i s_glyph = load(&src.glyphs[s]);
+				const __m128i skip = _mm_or_si128(_mm_cmpeq_epi32(s_glyph, empty), _mm_cmpeq_epi32(s_glyph, nul));
+
+				const __m128i d_glyph = load(&dst.glyphs[d]);
+				const __m128i d_fg = load(&dst.foregrounds[d]);
+				const __m128i d_bg = load(&dst.backgrounds[d]);
+
+				__m128i fg = (T & FG) ? d_fg : (C & FG) ? override_fg : load(&src.foregrounds[s]);
+				__m128i bg = (T & BG) ? d_bg : (C & BG) ? override_bg : load(&src.backgrounds[s]);
+
+				uint32_t s_a, d_a;
+				std::memcpy(&s_a, &src.attributes[s], 4);
+				std::memcpy(&d_a, &dst.attributes[d], 4);
+				const __m128i d_a_v = widenAttributes(d_a);
+
+				const __m128i glyph = select(skip, d_glyph, s_glyph);
+				fg = select(skip, d_fg, fg);
+				bg = select(skip, d_bg, bg);
+				const __m128i a_v = select(skip, d_a_v, widenAttributes((s_a & keep_bits) | (d_a & t_bits)));
+
+				const __m128i same = _mm_and_si128(
+					_mm_and_si128(_mm_cmpeq_epi32(glyph, d_glyph), _mm_cmpeq_epi32(fg, d_fg)),
+					_mm_and_si128(_mm_cmpeq_epi32(bg, d_bg), _mm_cmpeq_epi32(a_v, d_a_v))
+				);
+				const int changed = ~_mm_movemask_ps(_mm_castsi128_ps(same)) & 0xF;
+
+				if (changed != 0)
+				{
+					store(&dst.glyphs[d], glyph);
+					store(&dst.foregrounds[d], fg);
+					store(&dst.backgrounds[d], bg);
+
+					const __m128i a_16 = _mm_packs_epi32(a_v, a_v);
+					const uint32_t a = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(a_16, a_16)));
+					std::memcpy(&dst.attributes[d], &a, 4);
+
+					const int first = (changed & 1) ? 0 : (changed & 2) ? 1 : (changed & 4) ? 2 : 3;
+					const int last = (changed & 8) ? 3 : (changed & 4) ? 2 : (changed & 2) ? 1 : 0;
+					changed_begin = std::min(changed_begin, i + first);
+					changed_end = i + last + 1;
+				}
+			}
+			return i;
+		}
+#endif
+
+		template<uint8_t C, uint8_t T>
+		void blitRow(
+			symbol_grid& dst, size_t dst_i,
+			const symbol_grid& src, size_t src_i,
+			int count,
+			uint32_t c_fg, uint32_t c_bg,
+			int& changed_begin, int& changed_end
+		)
+		{
+			int begin = 0;
+#ifdef TUI_BLIT_SSE2
+			if (T != SOURCE_TRANSPARENCY)
+			{
+				begin = blitRowSse2<C, T>(dst, dst_i, src, src_i, count, c_fg, c_bg, changed_begin, changed_end);
+			}
+#endif
+			blitRowScalar<C, T>(dst, dst_i, src, src_i, begin, count, c_fg, c_bg, changed_begin, changed_end);
+		}
+
+		//c_mask - colors replaced by color override, t - transparency override or SOURCE_TRANSPARENCY
+		inline kernel getKernel(uint8_t c_mask, uint8_t t)
+		{
+			static const kernel kernels[4][5] =
+			{
+				{ &blitRow<0, 0>, &blitRow<0, 1>, &blitRow<0, 2>, &blitRow<0, 3>, &blitRow<0, SOURCE_TRANSPARENCY> },
+				{ &blitRow<1, 0>, &blitRow<1, 1>, &blitRow<1, 2>, &blitRow<1, 3>, &blitRow<1, SOURCE_TRANSPARENCY> },
+				{ &blitRow<2, 0>, &blitRow<2, 1>, &blitRow<2, 2>, &blitRow<2, 3>, &blitRow<2, SOURCE_TRANSPARENCY> },
+				{ &blitRow<3, 0>, &blitRow<3, 1>, &blitRow<3, 2>, &blitRow<3, 3>, &blitRow<3, SOURCE_TRANSPARENCY> }
+			};
+			return kernels[c_mask][t];
+		}
+	}
+}
\ No newline at end of file
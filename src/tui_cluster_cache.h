@@ -0,0 +1,107 @@
+//this file contains cluster_cache, memoizes results of symbol::setCluster()
+#pragma once
+#include "tui_glyph_table.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+namespace tui
+{
+	/*bounded cache mapping bytes passed to symbol::setCluster() to id of resulting glyph(normalized cluster and width),
+	direct-mapped - entry replaces previous one with the same slot, slots are guarded by striped locks*/
+	struct cluster_cache
+	{
+	private:
+		static constexpr unsigned int slot_count = 4096;//power of 2
+		static constexpr unsigned int lock_count = 64;
+
+		struct slot
+		{
+			std::string key;
+			uint32_t id;
+			bool used = false;
+		};
+
+		std::vector<slot> m_slots;
+		std::mutex m_locks[lock_count];//slot i is guarded by lock i % lock_count
+
+		std::atomic<uint64_t> m_hits;
+		std::atomic<uint64_t> m_misses;
+
+		//FNV-1a
+		static unsigned int getSlot(const char* cluster, size_t size)
+		{
+			uint32_t h = 2166136261u;
+			for (size_t i = 0; i < size; i++)
+			{
+				h = (h ^ static_cast<unsigned char>(cluster[i])) * 16777619u;
+			}
+			return h & (slot_count - 1);
+		}
+
+	public:
+		cluster_cache() : m_slots(slot_count), m_hits(0), m_misses(0) {}
+		cluster_cache(const cluster_cache&) = delete;
+		cluster_cache& operator=(const cluster_cache&) = delete;
+
+		//returns false if cluster is not cached
+		bool find(const char* cluster, size_t size, uint32_t& id)
+		{
+			const unsigned int s = getSlot(cluster, size);
+			{
+				std::lock_guard<std::mutex> lock(m_locks[s % lock_count]);
+
+				const slot& sl = m_slots[s];
+				if (sl.used && sl.key.size() == size && std::memcmp(sl.key.data(), cluster, size) == 0)
+				{
+					id = sl.id;
+					m_hits.fetch_add(1, std::memory_order_relaxed);
+					return true;
+				}
+			}
+			m_misses.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		void insert(const char* cluster, size_t size, uint32_t id)
+		{
+			const unsigned int s = getSlot(cluster, size);
+			std::lock_guard<std::mutex> lock(m_locks[s % lock_count]);
+
+			slot& sl = m_slots[s];
+			sl.key.assign(cluster, size);
+			sl.id = id;
+			sl.used = true;
+		}
+
+		void clear()
+		{
+			for (unsigned int s = 0; s < slot_count; s++)
+			{
+				std::lock_guard<std::mutex> lock(m_locks[s % lock_count]);
+				m_slots[s].used = false;
+			}
+		}
+
+		//counters for tuning, find() calls that returned true and false
+		uint64_t getHits() const { return m_hits.load(std::memory_order_relaxed); }
+		uint64_t getMisses() const { return m_misses.load(std::memory_order_relaxed); }
+		void resetCounters()
+		{
+			m_hits.store(0, std::memory_order_relaxed);
+			m_misses.store(0, std::memory_order_relaxed);
+		}
+
+		static constexpr unsigned int getCapacity() { return slot_count; }
+	};
+
+	inline cluster_cache& getClusterCache()
+	{
+		static cluster_cache cache;
+		return cache;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+//this file contains functions converting rgb colors for terminals without rgb color support
+#pragma once
+#include "tui_color.h"
+
+#include <array>
+#include <cstdint>
+
+namespace tui
+{
+	//16 colors in order of windows console attributes
+	inline const std::array<rgb, 16>& getRgbiPalette()
+	{
+		static const std::array<rgb, 16> palette =
+		{
+			COLOR::BLACK, COLOR::BLUE, COLOR::GREEN, COLOR::CYAN,
+			COLOR::RED, COLOR::MAGENTA, COLOR::BROWN, COLOR::LIGHTGRAY,
+			COLOR::DARKGRAY, COLOR::LIGHTBLUE, COLOR::LIGHTGREEN, COLOR::LIGHTCYAN,
+			COLOR::LIGHTRED, COLOR::LIGHTMAGENTA, COLOR::YELLOW, COLOR::WHITE
+		};
+		return palette;
+	}
+
+	//squared euclidean distance
+	inline int rgbDistance(rgb c1, rgb c2)
+	{
+		return (c1.r - c2.r) * (c1.r - c2.r) + (c1.g - c2.g) * (c1.g - c2.g) + (c1.b - c2.b) * (c1.b - c2.b);
+	}
+
+	//returns index of closest color from getRgbiPalette(), exhaustive search
+	inline uint8_t rgbToRgbiExact(rgb c)
+	{
+		const std::array<rgb, 16>& palette = getRgbiPalette();
+
+		uint8_t smallest_dst_id = 0;
+		int smallest_dst = rgbDistance(c, palette[0]);
+
+		for (size_t i = 1; i < palette.size(); i++)
+		{
+			int dst = rgbDistance(c, palette[i]);
+			if (dst < smallest_dst)
+			{
+				smallest_dst = dst;
+				smallest_dst_id = i;
+			}
+		}
+		return smallest_dst_id;
+	}
+
+	/*returns index of closest color from getRgbiPalette(),
+	uses 32x32x32 lookup cube(each channel quantized to 5 bits) computed on first use*/
+	inline uint8_t rgbToRgbi(rgb c)
+	{
+		static const std::array<uint8_t, 32 * 32 * 32> cube = []()
+		{
+			std::array<uint8_t, 32 * 32 * 32> cb;
+			for (int r = 0; r < 32; r++)
+			{
+				for (int g = 0; g < 32; g++)
+				{
+					for (int b = 0; b < 32; b++)
+					{
+						//center of cell
+						cb[r << 10 | g << 5 | b] = rgbToRgbiExact(rgb(r << 3 | 4, g << 3 | 4, b << 3 | 4));
+					}
+				}
+			}
+			return cb;
+		}();
+
+		return cube[(c.r >> 3) << 10 | (c.g >> 3) << 5 | c.b >> 3];
+	}
+
+	/*returns closest color from xterm 256 color palette,
+	only 6x6x6 color cube(16-231) and grayscale ramp(232-255) are used as first 16 colors are terminal defined*/
+	inline uint8_t rgbToXterm256(rgb c)
+	{
+		static const uint8_t levels[6] = { 0, 95, 135, 175, 215, 255 };
+
+		auto toLevel = [](uint8_t v)
+		{
+			return v < 48 ? 0 : v < 115 ? 1 : (v - 35) / 40;
+		};
+
+		const int r_l = toLevel(c.r);
+		const int g_l = toLevel(c.g);
+		const int b_l = toLevel(c.b);
+		const rgb cube_c(levels[r_l], levels[g_l], levels[b_l]);
+
+		const int avg = (c.r + c.g + c.b) / 3;
+		const int gray_l = avg < 8 ? 0 : avg > 238 ? 23 : (avg - 3) / 10;
+		const uint8_t gray_v = 8 + gray_l * 10;
+		const rgb gray_c(gray_v, gray_v, gray_v);
+
+		if (rgbDistance(c, gray_c) < rgbDistance(c, cube_c))
+		{
+			return 232 + gray_l;
+		}
+		return 16 + 36 * r_l + 6 * g_l + b_l;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,160 @@
+//this file contains escape_encoder, builds terminal escape sequences in reusable buffer without temporary strings
+#pragma once
+#include "tui_color.h"
+#include "tui_vec2.h"
+
+#include <array>
+#include <string>
+
+namespace tui
+{
+	struct escape_encoder
+	{
+	private:
+		struct dec_number
+		{
+			char digits[3];
+			uint8_t length;
+		};
+
+		//decimal representations of 0-255
+		static const std::array<dec_number, 256>& decTable()
+		{
+			static const std::array<dec_number, 256> table = []()
+			{
+				std::array<dec_number, 256> t;
+				for (unsigned int i = 0; i < t.size(); i++)
+				{
+					if (i >= 100)
+					{
+						t[i] = { { char('0' + i / 100), char('0' + i / 10 % 10), char('0' + i % 10) }, 3 };
+					}
+					else if (i >= 10)
+					{
+						t[i] = { { char('0' + i / 10), char('0' + i % 10), 0 }, 2 };
+					}
+					else
+					{
+						t[i] = { { char('0' + i), 0, 0 }, 1 };
+					}
+				}
+				return t;
+			}();
+
+			return table;
+		}
+
+		std::string m_buffer;
+		bool m_sgr_param = false;
+
+		void sgrSeparator()
+		{
+			if (m_sgr_param) { m_buffer += ';'; }
+			m_sgr_param = true;
+		}
+
+	public:
+		//capacity is kept, buffer does not reallocate once it grows to frame size
+		void clear() { m_buffer.clear(); }
+		void reserve(size_t size) { m_buffer.reserve(size); }
+
+		const std::string& getBuffer() const { return m_buffer; }
+		size_t size() const { return m_buffer.size(); }
+
+		void append(const char* data, size_t size) { m_buffer.append(data, size); }
+		void append(const std::string& str) { m_buffer.append(str); }
+		void append(char c) { m_buffer += c; }
+
+		void appendNumber(uint8_t n)
+		{
+			const dec_number& d = decTable()[n];
+			m_buffer.append(d.digits, d.length);
+		}
+		void appendNumber(unsigned int n)
+		{
+			if (n < 256)
+			{
+				appendNumber(static_cast<uint8_t>(n));
+				return;
+			}
+
+			char digits[10];
+			int i = sizeof(digits);
+			while (n > 0)
+			{
+				digits[--i] = '0' + n % 10;
+				n /= 10;
+			}
+			m_buffer.append(digits + i, sizeof(digits) - i);
+		}
+
+		//CUP, position is 0 based
+		void appendCursorPosition(vec2i position)
+		{
+			m_buffer.append("\033[", 2);
+			appendNumber(static_cast<unsigned int>(position.y + 1));
+			m_buffer += ';';
+			appendNumber(static_cast<unsigned int>(position.x + 1));
+			m_buffer += 'H';
+		}
+
+		/*SGR is built from parameters appended between beginSgr() and endSgr(),
+		so color and attribute changes are emitted as single sequence*/
+		void beginSgr()
+		{
+			m_buffer.append("\033[", 2);
+			m_sgr_param = false;
+		}
+		void endSgr()
+		{
+			m_buffer += 'm';
+		}
+
+		void sgrParam(const char* param, size_t size)
+		{
+			sgrSeparator();
+			m_buffer.append(param, size);
+		}
+		void sgrParam(const std::string& param) { sgrParam(param.data(), param.size()); }
+
+		void sgrUnderscore(bool underscore)
+		{
+			if (underscore) { sgrParam("4", 1); }
+			else { sgrParam("24", 2); }
+		}
+
+		//38;2;r;g;b
+		void sgrForegroundRgb(rgb c)
+		{
+			sgrParam("38;2;", 5);
+			appendNumber(c.r);
+			m_buffer += ';';
+			appendNumber(c.g);
+			m_buffer += ';';
+			appendNumber(c.b);
+		}
+		//48;2;r;g;b
+		void sgrBackgroundRgb(rgb c)
+		{
+			sgrParam("48;2;", 5);
+			appendNumber(c.r);
+			m_buffer += ';';
+			appendNumber(c.g);
+			m_buffer += ';';
+			appendNumber(c.b);
+		}
+
+		//38;5;n
+		void sgrForeground256(uint8_t n)
+		{
+			sgrParam("38;5;", 5);
+			appendNumber(n);
+		}
+		//48;5;n
+		void sgrBackground256(uint8_t n)
+		{
+			sgrParam("48;5;", 5);
+			appendNumber(n);
+		}
+	};
+}
\ No newline at end of file
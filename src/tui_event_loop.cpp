@@ -0,0 +1,238 @@
+#include "tui_event_loop.h"
+
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+#if defined(_WIN32)
+	#include <condition_variable>
+#endif
+
+#if defined(__linux__) || defined(__unix__)
+	#include <poll.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace tui
+{
+	namespace event_loop
+	{
+		struct timer
+		{
+			unsigned int id;
+			std::chrono::steady_clock::time_point deadline;
+			std::chrono::milliseconds interval;
+			std::function<void()> func;
+			bool repeat;
+		};
+
+		std::vector<timer> timers;
+		unsigned int next_timer_id = 0;
+
+		std::once_flag init_flag;
+
+#if defined(__linux__) || defined(__unix__)
+		struct fd_watch
+		{
+			int fd;
+			std::function<void()> func;
+		};
+
+		std::vector<fd_watch> fds;
+		std::vector<pollfd> poll_fds;//reused between wait() calls
+
+		//self-pipe, written by wakeup()
+		int wakeup_read_fd = -1;
+		std::atomic<int> wakeup_write_fd(-1);
+#endif
+#if defined(_WIN32)
+		std::mutex wakeup_mtx;
+		std::condition_variable wakeup_cv;
+		bool woken = false;
+#endif
+
+		void init()
+		{
+			std::call_once(init_flag, []
+			{
+#if defined(__linux__) || defined(__unix__)
+				int p[2];
+				if (pipe(p) == 0)
+				{
+					for (int fd : p)
+					{
+						fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+						fcntl(fd, F_SETFD, FD_CLOEXEC);
+					}
+					wakeup_read_fd = p[0];
+					wakeup_write_fd = p[1];
+				}
+#endif
+			});
+		}
+
+		void wakeup()
+		{
+#if defined(__linux__) || defined(__unix__)
+			int fd = wakeup_write_fd.load();
+			if (fd >= 0)
+			{
+				char c = 0;
+				ssize_t r = write(fd, &c, 1);//pipe could be full, it is readable anyway
+				(void)r;
+			}
+#endif
+#if defined(_WIN32)
+			{
+				std::lock_guard<std::mutex> lock(wakeup_mtx);
+				woken = true;
+			}
+			wakeup_cv.notify_one();
+#endif
+		}
+
+		//calls functions of due timers, returns true if any was due
+		bool runTimers()
+		{
+			const auto now = std::chrono::steady_clock::now();
+
+			std::vector<unsigned int> due;
+			for (const auto& t : timers)
+			{
+				if (t.deadline <= now) { due.push_back(t.id); }
+			}
+
+			//timer functions may add or remove timers
+			for (unsigned int id : due)
+			{
+				auto it = std::find_if(timers.begin(), timers.end(), [&](const timer& t) { return t.id == id; });
+				if (it == timers.end()) { continue; }
+
+				std::function<void()> func = it->func;
+
+				if (it->repeat)
+				{
+					it->deadline = std::max(it->deadline + it->interval, now);
+				}
+				else
+				{
+					timers.erase(it);
+				}
+
+				func();
+			}
+
+			return due.size() > 0;
+		}
+
+		bool wait(std::chrono::milliseconds timeout)
+		{
+			init();
+
+			//closest of timeout and timer deadlines, -1 - infinite
+			long long wait_ms = timeout.count() < 0 ? -1 : timeout.count();
+
+			const auto now = std::chrono::steady_clock::now();
+			for (const auto& t : timers)
+			{
+				//rounded up, so timer is due after waking
+				long long t_ms = (std::chrono::duration_cast<std::chrono::nanoseconds>(t.deadline - now).count() + 999999) / 1000000;
+				t_ms = std::max(t_ms, 0LL);
+
+				if (wait_ms < 0 || t_ms < wait_ms) { wait_ms = t_ms; }
+			}
+
+			bool happened = false;
+
+#if defined(__linux__) || defined(__unix__)
+			poll_fds.clear();
+			poll_fds.push_back({ wakeup_read_fd, POLLIN, 0 });
+			for (const auto& f : fds)
+			{
+				poll_fds.push_back({ f.fd, POLLIN, 0 });
+			}
+
+			int p = poll(poll_fds.data(), poll_fds.size(), static_cast<int>(std::min(wait_ms, 0x7FFFFFFFLL)));
+			if (p < 0)//interrupted by signal, its handler could have called wakeup()
+			{
+				p = poll(poll_fds.data(), poll_fds.size(), 0);
+			}
+
+			if (p > 0)
+			{
+				if (poll_fds[0].revents & POLLIN)
+				{
+					char buf[64];
+					while (read(wakeup_read_fd, buf, sizeof(buf)) > 0) {}
+					happened = true;
+				}
+
+				//fd functions may add or remove fds
+				for (size_t i = 1; i < poll_fds.size(); i++)
+				{
+					if (poll_fds[i].revents == 0) { continue; }
+
+					auto it = std::find_if(fds.begin(), fds.end(), [&](const fd_watch& f) { return f.fd == poll_fds[i].fd; });
+					if (it == fds.end()) { continue; }
+
+					std::function<void()> func = it->func;
+					func();
+					happened = true;
+				}
+			}
+#endif
+#if defined(_WIN32)
+			{
+				std::unique_lock<std::mutex> lock(wakeup_mtx);
+
+				if (wait_ms < 0)
+				{
+					wakeup_cv.wait(lock, [] { return woken; });
+				}
+				else
+				{
+					wakeup_cv.wait_for(lock, std::chrono::milliseconds(wait_ms), [] { return woken; });
+				}
+				happened = woken;
+				woken = false;
+			}
+#endif
+
+			return runTimers() || happened;
+		}
+
+		unsigned int addTimer(std::chrono::milliseconds interval, std::function<void()> func, bool repeat)
+		{
+			init();
+
+			timers.push_back({ next_timer_id, std::chrono::steady_clock::now() + interval, interval, func, repeat });
+			return next_timer_id++;
+		}
+		void removeTimer(unsigned int id)
+		{
+			timers.erase(
+				std::remove_if(timers.begin(), timers.end(), [&](const timer& t) { return t.id == id; }),
+				timers.end()
+			);
+		}
+
+#if defined(__linux__) || defined(__unix__)
+		void addFd(int fd, std::function<void()> func)
+		{
+			init();
+
+			removeFd(fd);
+			fds.push_back({ fd, func });
+		}
+		void removeFd(int fd)
+		{
+			fds.erase(
+				std::remove_if(fds.begin(), fds.end(), [&](const fd_watch& f) { return f.fd == fd; }),
+				fds.end()
+			);
+		}
+#endif
+	}
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+//this file contains declarations of event loop functions
+#pragma once
+#include <chrono>
+#include <functional>
+
+namespace tui
+{
+	namespace event_loop
+	{
+		//called by input::init(), other functions call it when needed
+		void init();
+
+		/*blocks until input arrives, terminal is resized(after output::init()), registered fd becomes readable,
+		registered timer is due, wakeup() is called or timeout passes(negative - no timeout),
+		fd and timer functions are called from here, returns false on timeout*/
+		bool wait(std::chrono::milliseconds timeout = std::chrono::milliseconds(-1));
+
+		//makes wait() return, could be called from any thread and from signal handler
+		void wakeup();
+
+		//timer function is called by wait() after interval(and then every interval if repeat is set), returns timer id
+		unsigned int addTimer(std::chrono::milliseconds interval, std::function<void()> func, bool repeat = true);
+		void removeTimer(unsigned int id);
+
+#if defined(__linux__) || defined(__unix__)
+		//func is called by wait() when fd is readable
+		void addFd(int fd, std::function<void()> func);
+		void removeFd(int fd);
+#endif
+
+		/*EXAMPLE
+
+		tui::init();
+		tui::event_loop::addTimer(std::chrono::milliseconds(500), [&] { blink = !blink; });
+
+		for (;;)
+		{
+			tui::event_loop::wait();//~0% cpu usage while idle
+
+			tui::output::clear();
+			...
+			tui::output::display();//setFpslimit() still limits rate of displaying
+		}
+		*/
+	}
+}
\ No newline at end of file
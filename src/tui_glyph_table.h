@@ -0,0 +1,113 @@
+//this file contains glyph_table, assigns small integer ids to unique grapheme clusters
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+
+namespace tui
+{
+	struct glyph
+	{
+		std::string cluster;
+		uint8_t width;
+	};
+
+	/*ids are never released, entries are immutable after insertion,
+	getGlyph() does not lock - storage is divided into chunks which are never moved*/
+	struct glyph_table
+	{
+	public:
+		enum RESERVED_ID : uint32_t
+		{
+			EMPTY = 0, //"", treated as fully transparent
+			REPLACEMENT = 1, //U+FFFD, used when table is full
+			ASCII_BASE = 2, //single byte clusters 0-127 have ids ASCII_BASE + byte
+			NUL = ASCII_BASE //"\0", treated as fully transparent
+		};
+
+	private:
+		static constexpr unsigned int chunk_bits = 10;
+		static constexpr unsigned int chunk_size = 1 << chunk_bits;
+		static constexpr unsigned int max_chunks = 4096;
+
+		std::atomic<glyph*> m_chunks[max_chunks];
+		uint32_t m_size = 0;
+		std::unordered_map<std::string, uint32_t> m_ids;
+		std::mutex m_mtx;
+
+		uint32_t insert(const std::string& cluster, uint8_t width)
+		{
+			uint32_t id = m_size;
+			unsigned int chunk = id >> chunk_bits;
+
+			glyph* c = m_chunks[chunk].load(std::memory_order_relaxed);
+			if (c == nullptr)
+			{
+				c = new glyph[chunk_size];
+			}
+			c[id & (chunk_size - 1)] = { cluster, width };
+			m_chunks[chunk].store(c, std::memory_order_release);
+
+			m_ids.emplace(cluster, id);
+			m_size++;
+
+			return id;
+		}
+
+	public:
+		glyph_table()
+		{
+			for (auto& c : m_chunks) { c.store(nullptr, std::memory_order_relaxed); }
+
+			insert(std::string(), 0);
+			insert("\xEF\xBF\xBD", 1);
+			for (int c = 0; c < 128; c++)
+			{
+				//control characters occupy no columns
+				insert(std::string(1, c), c < 0x20 || c == 0x7F ? 0 : 1);
+			}
+		}
+		~glyph_table()
+		{
+			for (auto& c : m_chunks) { delete[] c.load(); }
+		}
+		glyph_table(const glyph_table&) = delete;
+		glyph_table& operator=(const glyph_table&) = delete;
+
+		static bool isAscii(char c) { return static_cast<unsigned char>(c) < 128; }
+		//id of single byte cluster, does not access table
+		static uint32_t getAsciiId(char c) { return ASCII_BASE + static_cast<unsigned char>(c); }
+
+		//returns id of cluster, cluster is inserted if not present, width is used only when inserting
+		uint32_t getId(const char* cluster, uint8_t size, uint8_t width)
+		{
+			if (size == 1 && isAscii(cluster[0])) { return getAsciiId(cluster[0]); }
+
+			std::string key(cluster, size);
+
+			std::lock_guard<std::mutex> lock(m_mtx);
+
+			auto it = m_ids.find(key);
+			if (it != m_ids.end()) { return it->second; }
+
+			if (m_size == max_chunks * chunk_size) { return REPLACEMENT; }
+
+			return insert(key, width);
+		}
+
+		const glyph& getGlyph(uint32_t id) const
+		{
+			return m_chunks[id >> chunk_bits].load(std::memory_order_acquire)[id & (chunk_size - 1)];
+		}
+
+		static bool isTransparent(uint32_t id) { return id == EMPTY || id == NUL; }
+	};
+
+	inline glyph_table& getGlyphTable()
+	{
+		static glyph_table table;
+		return table;
+	}
+}
\ No newline at end of file
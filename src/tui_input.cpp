@@ -1,6 +1,9 @@
 #include "tui_input.h"
 #include "tui_terminal_info.h"
 #include "tui_unicode_utils.h"
+#include "tui_spsc_queue.h"
+#include "tui_event_loop.h"
+#include "tui_terminal_size.h"
 
 #include <thread>
 #include <mutex>
@@ -19,6 +22,7 @@
 #if defined(__linux__) || defined(__unix__) 
 	#include "termios.h"
 	#include "unistd.h" 
+	#include <poll.h>
 #endif
 
 namespace tui
@@ -33,37 +37,29 @@ namespace tui
 #if defined(__linux__) || defined(__unix__) 
 		termios default_settings;
 		termios noncanon_settings;
-		termios nonblocking_settings;
+
+		//how long remaining bytes of escape sequence or utf8 character are awaited
+		constexpr int inter_byte_timeout = 10;//ms
+		//how often input thread checks for termination request when there is no input
+		constexpr int terminate_check_interval = 100;//ms
 #endif
 		bool running = false;
 		bool terminate_req = false;
 		std::mutex sync_mtx;
 #if defined(_WIN32)
 		bool nonblocking = false;
-#endif
 
 		void useNonCanon()
 		{
-#if defined(__linux__) || defined(__unix__) 
-			tcsetattr(0, TCSANOW, &noncanon_settings);
-#endif
-#if defined(_WIN32)
 			nonblocking = false;
-#endif
 		}
 		void useNonBlocking()
 		{
-#if defined(__linux__) || defined(__unix__) 
-			tcsetattr(0, TCSANOW, &nonblocking_settings);
-#endif
-#if defined(_WIN32)
 			nonblocking = true;
-#endif
 		}
 
 		int gchar()
 		{
-#if defined(_WIN32)
 			switch (nonblocking)
 			{
 			case false:
@@ -89,21 +85,8 @@ namespace tui
 					return -1;
 				}
 			}
-#endif
-#if defined(__linux__) || defined(__unix__) 
-			char c;
-			size_t s = read(STDIN_FILENO, &c, 1);
-
-			if (s > 0)
-			{
-				return c;
-			}
-			else
-			{
-				return -1;
-			}
-#endif
 		}
+#endif
 
 		unsigned int expectedUtf8Len(char c)
 		{
@@ -127,35 +110,195 @@ namespace tui
 			return 0;
 		}
 
+#if defined(__linux__) || defined(__unix__) 
+		//bytes read from stdin which were not decoded yet
+		struct input_ring
+		{
+		private:
+			static constexpr size_t capacity = 4096;//power of 2
+
+			char m_data[capacity];
+			//positions grow monotonically, index is position % capacity
+			size_t m_begin = 0;
+			size_t m_end = 0;
+
+		public:
+			size_t size() const { return m_end - m_begin; }
+			bool isFull() const { return size() == capacity; }
+
+			char operator[](size_t i) const { return m_data[(m_begin + i) & (capacity - 1)]; }
+
+			void consume(size_t n) { m_begin += n; }
+
+			//reads available bytes with single read(), returns number of bytes read or -1
+			ssize_t readFrom(int fd)
+			{
+				const size_t idx = m_end & (capacity - 1);
+				const size_t len = std::min(capacity - size(), capacity - idx);
+
+				if (len == 0) { return 0; }
+
+				ssize_t r = read(fd, m_data + idx, len);
+				if (r > 0) { m_end += r; }
+				return r;
+			}
+		};
+#endif
+
+		//large enough to hold pasted text for a single frame
+		spsc_queue<event, 16384> event_queue;
+
+		//written only by input thread
 		struct keyboard_buffer
 		{
 		private:
-			std::mutex m_mtx;
+			//waits while queue is full
+			void pushEvent(const event& e)
+			{
+				while (!event_queue.push(e))
+				{
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+					std::lock_guard<std::mutex> lock(sync_mtx);
+					if (terminate_req) { return; }//main thread no longer reads input
+				}
+			}
+
 		public:
-			std::string raw[2];
-			std::string str[2];
-			std::vector<key_t> input[2];
+			void pushKey(key_t key)
+			{
+				event e;
+				e.type = EVENT_TYPE::KEY;
+				e.key = key;
+				e.size = 0;
+				pushEvent(e);
+			}
+			void push(unsigned char ch) { pushKey(ch); }
+
+			//complete utf8 character
+			void pushCodePoint(const char* bytes, uint8_t size)
+			{
+				event e;
+				e.type = EVENT_TYPE::CODE_POINT;
+				e.size = size;
+				std::copy(bytes, bytes + size, e.data);
+				size_t length;
+				e.code_point = decodeUtf8CodePoint(bytes, size, length);
+				pushEvent(e);
+			}
 
-			
+			void pushRaw(const char* bytes, size_t size)
+			{
+				event e;
+				e.type = EVENT_TYPE::RAW;
 
-			void bufferThread()
+				for (size_t i = 0; i < size; i += sizeof(e.data))
+				{
+					e.size = std::min(size - i, sizeof(e.data));
+					std::copy(bytes + i, bytes + i + e.size, e.data);
+					pushEvent(e);
+				}
+			}
+			void pushRaw(int ch)
+			{
+				if (ch != -1)
+				{
+					char c = ch;
+					pushRaw(&c, 1);
+				}
+			}
+
+#if defined(__linux__) || defined(__unix__) 
+			/*matches escape sequence at the beginning of ring,
+			returns sequence number and sets its length, -1 if there is no match, -2 if more bytes are needed*/
+			int matchSequence(const input_ring& ring, size_t& length)
+			{
+				const terminal_info& info = getTermInfo();
+				int node = 0;
+
+				for (length = 1; length <= ring.size(); length++)
+				{
+					node = info.getNextSeqNode(node, ring[length - 1]);
+					if (node < 0) { return -1; }
+
+					int n = info.getSeqNumberAt(node);
+					if (n >= 0) { return n; }
+				}
+				return -2;//valid prefix
+			}
+
+			/*decodes bytes from ring into events, escape sequence or utf8 character missing some bytes
+			is left in ring unless flush is set*/
+			void decode(input_ring& ring, bool flush)
 			{
-				auto push = [&](unsigned char ch)
+				while (ring.size() > 0)
 				{
-					input[1].push_back(ch);
+					const unsigned char c = ring[0];
 
-					if (ch >= 32 && ch != 127 && ch <= 255)
+					if (c == CTRL_C)
 					{
-						str[1] += ch;
+						CtrlcHandler();
 					}
-				};
-				auto pushRaw = [&](int ch)
-				{
-					if (ch != -1)
+
+					if (c == 127)//backspace could be 8 or 127
 					{
-						raw[1] += ch;
+						pushKey(BACKSPACE);
+						ring.consume(1);
 					}
-				};
+					else if (c == 27)//non-alphanumeric, consisting of more than one byte
+					{
+						size_t length;
+						int n = matchSequence(ring, length);
+
+						if (n == -2 && !flush) { return; }
+
+						if (n >= 0)
+						{
+							pushKey(n + TUI_KEY_OFFSET);
+							ring.consume(length);
+						}
+						else
+						{
+							push(c);
+							ring.consume(1);
+						}
+					}
+					else
+					{
+						const size_t length = expectedUtf8Len(c) + 1;
+
+						if (length == 1)
+						{
+							push(c);
+							ring.consume(1);
+						}
+						else if (ring.size() >= length)
+						{
+							char bytes[4];
+							for (size_t i = 0; i < length; i++) { bytes[i] = ring[i]; }
+
+							pushCodePoint(bytes, length);
+							ring.consume(length);
+						}
+						else if (flush)//incomplete character
+						{
+							for (size_t i = 0; i < ring.size(); i++) { push(ring[i]); }
+							ring.consume(ring.size());
+						}
+						else
+						{
+							return;
+						}
+					}
+				}
+			}
+#endif
+
+			void bufferThread()
+			{
+#if defined(__linux__) || defined(__unix__) 
+				input_ring ring;
+#endif
 
 				for (;;)
 				{
@@ -164,7 +307,6 @@ namespace tui
 					{
 						running = false;
 						terminate_req = false;
-						clear();
 #if defined(__linux__) || defined(__unix__) 
 						tcsetattr(0, TCSANOW, &default_settings);
 #endif
@@ -173,9 +315,44 @@ namespace tui
 					}
 					sync_mtx.unlock();
 
+#if defined(__linux__) || defined(__unix__) 
+					//incomplete sequence waits for its remaining bytes only for short time
+					pollfd pfd = { STDIN_FILENO, POLLIN, 0 };
+					int p = poll(&pfd, 1, ring.size() > 0 ? inter_byte_timeout : terminate_check_interval);
+
+					bool flush = false;
+					const size_t old_size = ring.size();
+
+					if (p > 0)
+					{
+						if (ring.readFrom(STDIN_FILENO) <= 0) { continue; }
+						flush = ring.isFull();
+					}
+					else if (p == 0 && ring.size() > 0)
+					{
+						flush = true;
+					}
+					else
+					{
+						continue;//no input or interrupted
+					}
 
+					char raw_buf[64];
+					size_t raw_len = 0;
+					for (size_t i = old_size; i < ring.size(); i++)
+					{
+						raw_buf[raw_len++] = ring[i];
+						if (raw_len == sizeof(raw_buf) || i + 1 == ring.size())
+						{
+							pushRaw(raw_buf, raw_len);
+							raw_len = 0;
+						}
+					}
+					decode(ring, flush);
+					event_loop::wakeup();
+#endif
+#if defined(_WIN32)
 					int gc = gchar();
-					m_mtx.lock();
 					pushRaw(gc);
 
 					if (gc == CTRL_C)
@@ -183,7 +360,6 @@ namespace tui
 						CtrlcHandler();
 					}
 
-#if defined(_WIN32)
 					if (gc != 0 && gc != 224)
 					{
 						push(gc);
@@ -192,15 +368,15 @@ namespace tui
 					{
 						useNonBlocking();
 						int gc2 = gchar();
-						raw[1] += gc2;
+						pushRaw(gc2);
 						useNonCanon();
 
 						switch (gc2 != -1)
 						{
 						case true:
-							if (term_info.getSeqNumber({gc, gc2 }) >= 0)
+							if (getTermInfo().getSeqNumber({gc, gc2 }) >= 0)
 							{
-								input[1].push_back(term_info.getSeqNumber({gc, gc2 }) + TUI_KEY_OFFSET);
+								pushKey(getTermInfo().getSeqNumber({gc, gc2 }) + TUI_KEY_OFFSET);
 							}
 							else
 							{
@@ -212,59 +388,7 @@ namespace tui
 							push(gc);
 						}
 					}
-#endif
-#if defined(__linux__) || defined(__unix__) 
-					if (gc == 127)//backspace could be 8 or 127
-					{
-						input[1].push_back(BACKSPACE);
-					}
-					else if (gc != 27)
-					{
-						push(gc);
-					}
-					else//non-alphanumeric, consisting of more than one byte
-					{
-						useNonBlocking();
-						std::vector<int> buf = { 27 };
 
-						auto copyToBuffer = [&]()
-						{
-							for (int j = 0; j < buf.size(); j++)
-							{
-								push(buf[j]);
-							}
-						};
-
-						for (int i = 0; i < term_info.longest_seq; i++)
-						{
-							int gcn = gchar();
-							pushRaw(gcn);
-
-							if (gcn == -1)//no input
-							{
-								copyToBuffer();
-								break;
-							}
-							else
-							{
-								buf.push_back(gcn);
-							}
-
-							if (term_info.getSeqNumber(buf) >= 0)
-							{
-								input[1].push_back(term_info.getSeqNumber(buf) + TUI_KEY_OFFSET);
-								break;
-							}
-
-							if (i == term_info.longest_seq - 1)
-							{
-								copyToBuffer();
-								break;
-							}
-						}
-						useNonCanon();
-					}
-#endif
 					char utf8_buf[3] = { 0,0,0 };
 					unsigned int buf_len = 0;
 
@@ -288,42 +412,33 @@ namespace tui
 					{
 						push(utf8_buf[i]);
 					}
-
-
-					m_mtx.unlock();
+					event_loop::wakeup();
+#endif
 				}
 			}
+		};
+		keyboard_buffer buffer;
 
-			void swap()
-			{
-				m_mtx.lock();
-
-				raw[0] = raw[1];
-				str[0] = str[1];
-				input[0] = input[1];
-
-				raw[1].clear();
-				str[1].clear();
-				input[1].clear();
-
-				m_mtx.unlock();
-			}
+		//input since last swap(), used only by main thread
+		struct frame_input
+		{
+			std::vector<event> events;
+			std::vector<key_t> keys;
+			std::string raw;
+			std::string str;
+			std::u32string code_points;
 
 			void clear()
 			{
-				m_mtx.lock();
-
-				raw[0].clear();
-				raw[1].clear();
-				str[0].clear();
-				str[1].clear();
-				input[0].clear();
-				input[1].clear();
-
-				m_mtx.unlock();
+				events.clear();
+				keys.clear();
+				raw.clear();
+				str.clear();
+				code_points.clear();
 			}
 		};
-		keyboard_buffer buffer;
+		frame_input current;
+		unsigned int last_resize_count = 0;
 
 		void restore()
 		{
@@ -336,7 +451,7 @@ namespace tui
 
 #if defined(__linux__) || defined(__unix__) 
 			tcsetattr(0, TCSANOW, &default_settings);
-			std::cout << term_info.rmkx;
+			std::cout << getTermInfo().rmkx;
 #endif
 		}
 
@@ -344,7 +459,7 @@ namespace tui
 		{
 #if defined(__linux__) || defined(__unix__) 
 			tcsetattr(0, TCSANOW, &default_settings);
-			std::cout << term_info.rmkx;
+			std::cout << getTermInfo().rmkx;
 #endif
 		}
 
@@ -357,16 +472,19 @@ namespace tui
 			noncanon_settings.c_lflag &= ~(ICANON | ECHO | ISIG | IEXTEN);
 			noncanon_settings.c_iflag &= ~(ICRNL | IXON);
 
-			nonblocking_settings = noncanon_settings;
-			nonblocking_settings.c_cc[VMIN] = 0;
-			nonblocking_settings.c_cc[VTIME] = 0;
-
 			tcsetattr(0, TCSANOW, &noncanon_settings);
-			std::cout << term_info.smkx;
+			std::cout << getTermInfo().smkx;
 #endif	
 
 			std::atexit(restoreExit);
 
+			event_loop::init();//input thread wakes event loop
+			last_resize_count = getTerminalResizeCount();//initial size is not a resize
+
+			//events from before restore() are not delivered
+			event_queue.drain([](const event&) {});
+			current.clear();
+
 			sync_mtx.lock();
 
 			switch (running)
@@ -383,39 +501,92 @@ namespace tui
 			sync_mtx.unlock();
 		}
 
-		std::vector<key_t> getInput()
+		const std::vector<event>& getEvents()
+		{
+			return current.events;
+		}
+		const std::vector<key_t>& getInput()
 		{
-			return buffer.input[0];
+			return current.keys;
 		}
-		std::string getRawInput()
+		const std::string& getRawInput()
 		{
-			return buffer.raw[0];
+			return current.raw;
 		}
-		std::string getStringInput()
+		const std::string& getStringInput()
 		{
-			return buffer.str[0];
+			return current.str;
 		}
 
 		int isKeyPressed(key_t key)
 		{
 			if (key >= 0)
 			{
-				std::vector<key_t>& input = buffer.input[0];
-				return std::count(input.begin(), input.end(), key);
-
+				return std::count(current.keys.begin(), current.keys.end(), key);
 			}
 			return false;
 		}
 
 		int isCodePointPressed(char32_t code_point)
 		{
-			std::u32string u32_str = utf8ToUtf32(buffer.str[0]);
-			return std::count(u32_str.begin(), u32_str.end(), code_point);
+			return std::count(current.code_points.begin(), current.code_points.end(), code_point);
 		}
 
-		void swap() { buffer.swap(); }
+		void swap()
+		{
+			current.clear();
+
+			event_queue.drain([](const event& e)
+			{
+				current.events.push_back(e);
 
-		void clear() { buffer.clear(); }
+				switch (e.type)
+				{
+				case EVENT_TYPE::KEY:
+					current.keys.push_back(e.key);
+					if (e.key >= 32 && e.key != 127 && e.key <= 255)
+					{
+						current.str += static_cast<char>(e.key);
+					}
+					break;
+				case EVENT_TYPE::CODE_POINT:
+					for (int i = 0; i < e.size; i++)
+					{
+						current.keys.push_back(static_cast<unsigned char>(e.data[i]));
+					}
+					current.str.append(e.data, e.size);
+					break;
+				case EVENT_TYPE::RAW:
+					current.raw.append(e.data, e.size);
+					break;
+				case EVENT_TYPE::RESIZE:
+					break;
+				}
+			});
+
+			//capacity of previous frame is reused
+			current.code_points.resize(current.str.size());
+			current.code_points.resize(decodeUtf8(current.str.data(), current.str.size(), &current.code_points[0]));
+
+			//resize is not passed through queue, it is detected by SIGWINCH handler
+			const unsigned int resize_count = getTerminalResizeCount();
+			if (resize_count != last_resize_count)
+			{
+				last_resize_count = resize_count;
+
+				event e;
+				e.type = EVENT_TYPE::RESIZE;
+				e.size = 0;
+				e.terminal_size = getTerminalSize();
+				current.events.push_back(e);
+			}
+		}
+
+		void clear()
+		{
+			event_queue.drain([](const event&) {});
+			current.clear();
+		}
 
 		bool isKeySupported(key_t key)
 		{
@@ -423,10 +594,10 @@ namespace tui
 			else if (key >= KEY::PGUP && key <= KEY::CTRL_RIGHT)
 			{
 #if defined(__linux__) || defined(__unix__) 
-				return term_info.getSeq(key - TUI_KEY_OFFSET).size() > 0;
+				return getTermInfo().getSeq(key - TUI_KEY_OFFSET).size() > 0;
 #endif
 #if defined(_WIN32)
-				return term_info.getSeq(key - TUI_KEY_OFFSET)[0] != -1;
+				return getTermInfo().getSeq(key - TUI_KEY_OFFSET)[0] != -1;
 #endif
 			}
 			return false;	
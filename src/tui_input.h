@@ -1,7 +1,10 @@
 //this file contains declarations of input functions and keys enums
 #pragma once
+#include "tui_vec2.h"
+
 #include <string>
 #include <vector>
+#include <cstdint>
 
 #define TUI_KEY_OFFSET 0xF00 //could be any value above 255
 
@@ -136,17 +139,39 @@ namespace tui
 			CTRL_Z = 26
 		};
 
+		enum class EVENT_TYPE : uint8_t
+		{
+			KEY, //key - character byte or value of KEY
+			CODE_POINT, //code_point, its utf8 bytes are in data
+			RAW, //uninterpreted bytes in data
+			RESIZE //terminal_size
+		};
+
+		//single input event, passed from input thread to main thread
+		struct event
+		{
+			EVENT_TYPE type;
+			uint8_t size;//number of bytes in data
+			key_t key;
+			char32_t code_point;
+			vec2i terminal_size;
+			char data[16];
+		};
+
 		void init();
 
 		void restore();
 
-		std::vector<key_t> getInput();
+		//events in order of arrival
+		const std::vector<event>& getEvents();
+
+		const std::vector<key_t>& getInput();
 
 		//uninterpreted input
-		std::string getRawInput();
+		const std::string& getRawInput();
 
 		//alphanumerical input
-		std::string getStringInput();
+		const std::string& getStringInput();
 
 		//amount of key press
 		int isKeyPressed(key_t key);
@@ -154,10 +179,10 @@ namespace tui
 		//amount of key press
 		int isCodePointPressed(char32_t code_point);
 
-		//swap buffers
+		//swap buffers, input queued by input thread becomes current one
 		void swap();
 
-		//clear buffers
+		//clear buffers, including queued input
 		void clear();
 
 		bool isKeySupported(key_t key);
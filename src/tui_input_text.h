@@ -67,7 +67,7 @@ namespace tui
 	{
 	private:
 		text m_text;
-		symbol_string m_str;
+		symbol_rope m_str;
 		vec2i m_cursor_pos = { 0,0 };
 		unsigned int m_cursor_sym_idx = 0;
 		time_frame m_cursor_blink;
@@ -120,24 +120,36 @@ namespace tui
 			if (m_cursor_pos != old_pos) { m_redraw_needed = true; }
 		}
 
-		void updateText()
+		//returns str as displayed, characters are hidden in confidential mode
+		symbol_string getDisplayedText(symbol_string str) const
 		{
-			symbol_string s = m_str;
-			
 			if (m_confidential_mode)
 			{
-				for (int i = 0; i < s.size(); i++)
+				for (int i = 0; i < str.size(); i++)
 				{
-					if (s[i] != '\n') { s[i] = '*'; }
+					if (str[i] != '\n') { str[i] = '*'; }
 				}
 			}
-			
-			s += " ";
+			return str;
+		}
+
+		void updateText()
+		{
+			symbol_rope s = m_confidential_mode ? symbol_rope(getDisplayedText(m_str.getSymbolString())) : m_str;
+			s.push_back(' ');
 
 			if (m_cursor_sym_idx > m_str.size()) { m_cursor_sym_idx = m_str.size(); }
 
 			m_text.setText(s);
 		}
+
+		//replaces count symbols at idx, only edited part of displayed text is re-laid out
+		void replaceText(unsigned int idx, unsigned int count, const symbol_string& str)
+		{
+			m_str.erase(idx, count);
+			m_str.insert(idx, str);
+			m_text.replaceText(idx, count, getDisplayedText(str));
+		}
 		
 		void moveCursorRight(unsigned int n = 1)
 		{
@@ -346,11 +358,11 @@ namespace tui
 
 		void setText(const symbol_string& str)
 		{
-			m_str = str;
+			m_str = symbol_rope(str);
 			updateText();
 			m_redraw_needed = true;
 		}
-		symbol_string getText() const { return m_str; }
+		symbol_string getText() const { return m_str.getSymbolString(); }
 
 		void setCursorIndex(unsigned int idx)
 		{
@@ -385,26 +397,15 @@ namespace tui
 
 				auto addText = [&](symbol_string str)
 				{
+					if (str.size() == 0) { return; }
+
 					if (m_insert_mode)
 					{
-						for (int i = 0; i < str.size(); i++)
-						{
-							m_str.insert(m_str.begin() + m_cursor_sym_idx + i, str[i]);
-						}
+						replaceText(m_cursor_sym_idx, 0, str);
 					}
 					else//overtype
 					{
-						for (int i = 0; i < str.size(); i++)
-						{
-							if (i + m_cursor_sym_idx < m_str.size())
-							{
-								m_str[i + m_cursor_sym_idx] = str[i];
-							}
-							else
-							{
-								m_str.push_back(str[i]);
-							}
-						}
+						replaceText(m_cursor_sym_idx, std::min((unsigned int)str.size(), (unsigned int)m_str.size() - m_cursor_sym_idx), str);
 					}
 					moveCursorRight(str.size());
 				};
@@ -422,13 +423,6 @@ namespace tui
 						|| key == key_end;
 				};
 
-				bool update_needed = false;
-				auto update = [&]()
-				{
-					if (buffer.size() > 0 || update_needed) { updateText(); }
-					update_needed = false;
-				};
-
 				for (int i = 0; i < input.size(); i++)
 				{
 					if (isSpecialKey(input[i]))
@@ -439,10 +433,8 @@ namespace tui
 						{
 							if (m_cursor_sym_idx > 0)
 							{
-								m_str.erase(m_str.begin() + m_cursor_sym_idx - 1);
+								replaceText(m_cursor_sym_idx - 1, 1, symbol_string());
 								moveCursorLeft();
-
-								update_needed = true;
 							}
 						}
 						else if (input[i] == key_left)
@@ -455,32 +447,26 @@ namespace tui
 						}
 						else if (input[i] == key_up)
 						{
-							update();
 							moveCursorUp();
 						}
 						else if (input[i] == key_down)
 						{
-							update();
 							moveCursorDown();
 						}
 						else if (input[i] == key_pgup)
 						{
-							update();
 							moveCursorUp(getSize().y);
 						}
 						else if (input[i] == key_pgdn)
 						{
-							update();
 							moveCursorDown(getSize().y);
 						}
 						else if (input[i] == key_home)
 						{
-							update();
 							moveCursorHome();
 						}
 						else if (input[i] == key_end)
 						{
-							update();
 							moveCursorEnd();
 						}
 						else if (input[i] == key_insert)
@@ -508,7 +494,6 @@ namespace tui
 				}
 
 				addText((symbol_string)buffer);
-				update();
 
 			}
 		}
@@ -2,6 +2,7 @@
 
 #include "tui_input.h"
 #include "tui_output.h"
+#include "tui_event_loop.h"
 
 namespace tui
 {
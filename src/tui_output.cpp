@@ -3,6 +3,9 @@
 #include "tui_terminal_info.h"
 #include "tui_text_utils.h"
 #include "tui_time_frame.h"
+#include "tui_escape_encoder.h"
+#include "tui_color_quantization.h"
+#include "tui_terminal_size.h"
 
 #include <cstdlib>
 #include <vector>
@@ -15,15 +18,50 @@
 #endif
 
 #if defined(__linux__) || defined(__unix__) 
-	#include <sys/ioctl.h>
 	#include <unistd.h>
 	#include <termios.h>
+	#include <poll.h>
+	#include <cerrno>
 #endif
 
 namespace tui
 {
 	namespace output
 	{
+#if defined(__linux__) || defined(__unix__) 
+		//writes whole data, retries after interruption and partial write, returns number of written bytes
+		size_t writeAll(int fd, const char* data, size_t size)
+		{
+			size_t written = 0;
+
+			while (written < size)
+			{
+				ssize_t w = write(fd, data + written, size - written);
+
+				if (w < 0)
+				{
+					if (errno == EINTR) { continue; }
+					if (errno == EAGAIN || errno == EWOULDBLOCK)
+					{
+						pollfd pfd = { fd, POLLOUT, 0 };
+						poll(&pfd, 1, -1);
+						continue;
+					}
+					break;
+				}
+				written += w;
+			}
+			return written;
+		}
+
+		//writes str directly to terminal, content buffered by std::cout is flushed first to keep order
+		size_t writeOutput(const std::string& str)
+		{
+			std::cout.flush();
+			return writeAll(STDOUT_FILENO, str.data(), str.size());
+		}
+#endif
+
 		struct console_buffer
 		{
 			surface buffer;
@@ -31,18 +69,47 @@ namespace tui
 
 			void resize(vec2i size) { buffer.setSizeInfo(size); }
 
-			void updateLastBuffer() { last_buffer = buffer; }
+			//copies only symbols modified since last update
+			void updateLastBuffer()
+			{
+				if (last_buffer.getSize() != buffer.getSize())
+				{
+					last_buffer = buffer;
+				}
+				else
+				{
+					const surface& c_buffer = buffer;
+
+					for (int y = 0; y < buffer.getSize().y; y++)
+					{
+						row_span span = buffer.getDirtySpan(y);
+
+						for (int x = span.begin; x < span.end; x++)
+						{
+							last_buffer[x][y] = c_buffer[x][y];
+						}
+					}
+				}
+				buffer.clearDirty();
+			}
 
-			bool isChanged()
+			//compares only symbols modified since last update
+			bool isChanged() const
 			{
 				if (last_buffer.getSize() != buffer.getSize())
 				{
 					return true;
 				}
+				if (!buffer.isDirty())
+				{
+					return false;
+				}
 
 				for (int y = 0; y < buffer.getSize().y; y++)
 				{
-					for (int x = 0; x < buffer.getSize().x; x++)
+					row_span span = buffer.getDirtySpan(y);
+
+					for (int x = span.begin; x < span.end; x++)
 					{
 						if (buffer[x][y] != last_buffer[x][y])
 						{
@@ -74,6 +141,11 @@ namespace tui
 			time_frame fps_control;
 			bool display_rgb = true;
 			bool display_rgbi = true;
+			bool display_256 = false;
+			bool display_diff = true;
+			bool full_redraw_needed = true;
+			escape_encoder out;//reused between frames to avoid reallocation
+			size_t frame_bytes = 0;
 
 			console() : fps_control(std::chrono::milliseconds(1000) / 30)
 			{
@@ -88,38 +160,17 @@ namespace tui
 
 				input::swap();
 
-				if (!isChanged()) { return; }
-
-				static const std::array<rgb, 16> colorRgbi =
-				{
-					COLOR::BLACK, COLOR::BLUE, COLOR::GREEN, COLOR::CYAN,
-					COLOR::RED, COLOR::MAGENTA, COLOR::BROWN, COLOR::LIGHTGRAY,
-					COLOR::DARKGRAY, COLOR::LIGHTBLUE, COLOR::LIGHTGREEN, COLOR::LIGHTCYAN,
-					COLOR::LIGHTRED, COLOR::LIGHTMAGENTA, COLOR::YELLOW, COLOR::WHITE
-				};
+				frame_bytes = 0;
 
-				auto rgbDst = [](rgb c1, rgb c2)
+				if (!isChanged())
 				{
-					return (c1.r - c2.r) * (c1.r - c2.r) + (c1.g - c2.g) * (c1.g - c2.g) + (c1.b - c2.b) * (c1.b - c2.b);
-				};
-
-				auto rgbToRgbi = [&](rgb c)
-				{
-					int smallest_dst_id = 0;
-					int smallest_dst = rgbDst(c, colorRgbi[0]);
+					buffer.clearDirty();//modified symbols are equal to displayed ones
+					return;
+				}
 
-					for (int i = 1; i < colorRgbi.size(); i++)
-					{
-						if (rgbDst(c, colorRgbi[i]) < smallest_dst)
-						{
-							smallest_dst = rgbDst(c, colorRgbi[i]);
-							smallest_dst_id = i;
-						}
-					}
-					return smallest_dst_id;
-				};
+				const surface& frame = buffer;//read only access, does not mark symbols as modified
 
-				auto getIColor = [](const symbol& s)
+				auto getIColor = [](const_symbol_ref s)
 				{
 					color c = s.getColor();
 					if (s.isInverted())
@@ -142,13 +193,15 @@ namespace tui
 					for (int x = 0; x < getSize().x;)
 					{
 						CHAR_INFO ch_info;
-						uint8_t sym_w = buffer[x][y].getWidth();
+						uint8_t sym_w = frame[x][y].getWidth();
 
-						char32_t c = utf8ToUtf32(buffer[x][y].getCluster())[0];
+						const std::string cluster = frame[x][y].getCluster();
+						size_t length;
+						char32_t c = decodeUtf8CodePoint(cluster.data(), cluster.size(), length);
 
 						if (c < pow(2, (sizeof(wchar_t) * 8)) && sym_w != 0)
 						{
-							uint8_t sym_w = buffer[x][y].getWidth();
+							uint8_t sym_w = frame[x][y].getWidth();
 
 							ch_info.Char.UnicodeChar = c;
 						}
@@ -156,14 +209,14 @@ namespace tui
 
 						if (display_rgbi)
 						{
-							ch_info.Attributes = getRgbiColor(getIColor(buffer[x][y]));
+							ch_info.Attributes = getRgbiColor(getIColor(frame[x][y]));
 						}
 						else
 						{
 							ch_info.Attributes = getRgbiColor({ COLOR::WHITE, COLOR::BLACK });
 						}
 
-						if (buffer[x][y].isUnderscore())
+						if (frame[x][y].isUnderscore())
 						{
 							ch_info.Attributes |= COMMON_LVB_UNDERSCORE;
 						}
@@ -190,6 +243,8 @@ namespace tui
 
 				SMALL_RECT srect = { 0,0,(SHORT)getSize().x, (SHORT)getSize().y };
 				WriteConsoleOutputW(console_handle, temp.data(), { (SHORT)getSize().x, (SHORT)getSize().y }, { 0,0 }, &srect);
+				frame_bytes = temp.size() * sizeof(CHAR_INFO);
+				hidePrompt();
 #endif
 
 #if defined(__linux__) || defined(__unix__) 
@@ -202,132 +257,174 @@ namespace tui
 				{
 					{ "30","34","32","36","31","35","33","37","30;1","34;1","32;1","36;1","31;1","35;1","33;1","37;1" }
 				};
-				auto getEscCodeRgbi = [&](color c)
+				const bool diff = display_diff && !full_redraw_needed && last_buffer.getSize() == getSize();
+
+				out.clear();
+				out.reserve(getSize().x * getSize().y);
+				if (!diff) { out.append(getTermInfo().home); }
+
+				color last_color;
+				bool last_underscore = false;
+				bool sgr_set = false;//terminal state is unknown until first sgr
+
+				auto appendSgr = [&](const_symbol_ref sym)
 				{
-					std::string esc_c = "\033[";
-					esc_c += fg[rgbToRgbi(c.foreground)];
-					esc_c += ";";
-					esc_c += bg[rgbToRgbi(c.background)];
-					esc_c += "m";
+					color c_color = getIColor(sym);
+					bool c_changed = !sgr_set || last_color != c_color;
+					bool u_changed = !sgr_set || last_underscore != sym.isUnderscore();
 
-					return esc_c;
+					if (u_changed || (c_changed && (display_rgbi || display_256 || display_rgb)))
+					{
+						out.beginSgr();
+						if (u_changed)
+						{
+							out.sgrUnderscore(sym.isUnderscore());
+						}
+						if (c_changed && display_rgbi)
+						{
+							out.sgrParam(fg[rgbToRgbi(c_color.foreground)]);
+							out.sgrParam(bg[rgbToRgbi(c_color.background)]);
+						}
+						if (c_changed && display_256)
+						{
+							out.sgrForeground256(rgbToXterm256(c_color.foreground));
+							out.sgrBackground256(rgbToXterm256(c_color.background));
+						}
+						if (c_changed && display_rgb)
+						{
+							out.sgrForegroundRgb(c_color.foreground);
+							out.sgrBackgroundRgb(c_color.background);
+						}
+						out.endSgr();
+					}
+					last_color = c_color;
+					last_underscore = sym.isUnderscore();
+					sgr_set = true;
 				};
-				auto getEscCodeRgb = [&](color c)
+
+				auto isSameAttributes = [](const_symbol_ref a, const_symbol_ref b)
 				{
-					std::string esc_c = "\033[38;2;";
-					esc_c += std::to_string(c.foreground.r);
-					esc_c += ";";
-					esc_c += std::to_string(c.foreground.g);
-					esc_c += ";";
-					esc_c += std::to_string(c.foreground.b);
-					esc_c += "m";
-
-					esc_c += "\033[48;2;";
-					esc_c += std::to_string(c.background.r);
-					esc_c += ";";
-					esc_c += std::to_string(c.background.g);
-					esc_c += ";";
-					esc_c += std::to_string(c.background.b);
-					esc_c += "m";
-
-					return esc_c;
+					const uint8_t mask = symbol_grid::INVERTED | symbol_grid::UNDERSCORE;
+					symbol_grid::cell a_c = a.getCell();
+					symbol_grid::cell b_c = b.getCell();
+					return a_c.foreground == b_c.foreground && a_c.background == b_c.background && (a_c.attributes & mask) == (b_c.attributes & mask);
 				};
 
-				std::string str = "\033[24m";
-				
-				color f_color = getIColor(buffer[0][0]);
-				if (display_rgbi)
-				{
-					str += getEscCodeRgbi(f_color);
-				}
-				if (display_rgb)
+				/*writes symbols from [x, x_end) of given row, symbols are grouped into runs of same attributes,
+				each run is preceded by at most one sgr and its clusters are copied directly from symbols,
+				returns column after last written symbol*/
+				auto appendRow = [&](int y, int x, int x_end)
 				{
-					str += getEscCodeRgb(f_color);
-				}
+					while (x < x_end)
+					{
+						const_symbol_ref run_front = frame[x][y];
+						if (x + run_front.getWidth() > getSize().x) { break; }
 
-				color last_color = f_color;
-				bool last_underscore = false;
+						appendSgr(run_front);
 
-				for (int y = 0; y < getSize().y; y++)
+						do
+						{
+							const_symbol_ref sym = frame[x][y];
+							uint8_t sym_w = sym.getWidth();
+
+							if (x + sym_w > getSize().x) { return x; }
+
+							//symbols with nonzero width are never control characters
+							size_t length;
+							if (sym_w > 0 || !isControl(decodeUtf8CodePoint(&sym[0], sym.size(), length)))
+							{
+								out.append(&sym[0], sym.size());
+							}
+							else
+							{
+								out.append("\xEF\xBF\xBD", 3);
+							}
+
+							x += sym_w > 0 ? sym_w : 1;
+						} while (x < x_end && isSameAttributes(frame[x][y], run_front));
+					}
+					return x;
+				};
+
+				auto getStep = [&](int x, int y)
 				{
-					for (int x = 0; x < getSize().x;)
+					uint8_t sym_w = frame[x][y].getWidth();
+					return sym_w > 0 ? sym_w : 1;
+				};
+
+				if (diff)
+				{
+					//only symbols different from displayed ones are written, each run is preceded by cursor positioning
+					const surface& last_frame = last_buffer;
+					vec2i cursor = { -1,-1 };
+
+					for (int y = 0; y < getSize().y; y++)
 					{
-						uint8_t sym_w = buffer[x][y].getWidth();
+						row_span span = buffer.getDirtySpan(y);
+						if (span.isEmpty()) { continue; }
 
-						if (x + sym_w > getSize().x)
+						//column covered by wide symbol in last frame, could be blanked when that symbol was overwritten
+						const int row_end = std::min(span.end + 1, getSize().x);
+
+						auto isChangedAt = [&](int x)
 						{
-							str += '\n';
-							break;
-						}
+							if (x > 0 && last_frame[x - 1][y].getWidth() > 1) { return true; }
+
+							for (int i = std::max(x, span.begin); i < std::min(x + getStep(x, y), span.end); i++)
+							{
+								if (frame[i][y] != last_frame[i][y]) { return true; }
+							}
+							return false;
+						};
 
-						color c_color = getIColor(buffer[x][y]);
-						if (last_color != c_color)
+						for (int x = 0; x < row_end;)
 						{
-							if (display_rgbi)
+							if (!isChangedAt(x))
 							{
-								str += getEscCodeRgbi(c_color);
+								x += getStep(x, y);
+								continue;
 							}
-							if (display_rgb)
+
+							int run_end = x;
+							while (run_end < row_end && isChangedAt(run_end))
 							{
-								str += getEscCodeRgb(c_color);
+								run_end += getStep(run_end, y);
 							}
-						}
-						last_color = c_color;
 
-						switch (buffer[x][y].isUnderscore())
-						{
-						case true:
-							if (last_underscore) { break; }
-							str += "\033[4m";
-							break;
-						case false:
-							if (!last_underscore) { break; }
-							str += "\033[24m";
-						}
-						last_underscore = buffer[x][y].isUnderscore();
+							if (cursor != vec2i(x, y))
+							{
+								out.appendCursorPosition({ x,y });
+							}
+							cursor = { appendRow(y, x, run_end), y };
 
-						if (!isControl(utf8ToUtf32(buffer[x][y].getCluster())[0]))
-						{
-							str += buffer[x][y].getCluster();
+							if (cursor.x < run_end) { break; }//symbol does not fit in row
+							x = run_end;
 						}
-						else
+					}
+				}
+				else
+				{
+					for (int y = 0; y < getSize().y; y++)
+					{
+						if (appendRow(y, 0, getSize().x) < getSize().x)
 						{
-							str += "\xEF\xBF\xBD";
+							out.append('\n');
 						}
-
-						
-						x += sym_w > 0 ? sym_w : 1;
 					}
+					full_redraw_needed = false;
 				}
 
-				/* if not doubled last few characters will be displayed after
-				some delay. I dont know why this happen*/
-				std::cout << term_info.home << str << term_info.home << str;
+				//whole frame(with cursor hiding sequence) is written with single unbuffered write
+				out.append(getTermInfo().civis);
+				frame_bytes = writeOutput(out.getBuffer());
 #endif
-				hidePrompt();
 				updateLastBuffer();
 			}
 
+			//size is cached and updated on resize, buffer is reallocated only when size changes
 			void updateSize()
 			{
-				vec2i console_size;
-
-#if defined(_WIN32)
-				CONSOLE_SCREEN_BUFFER_INFO buffer_info;
-				GetConsoleScreenBufferInfo(console_handle, &buffer_info);
-
-				console_size.x = buffer_info.srWindow.Right - buffer_info.srWindow.Left + 1;
-				console_size.y = buffer_info.srWindow.Bottom - buffer_info.srWindow.Top + 1;
-#endif
-
-#if defined(__linux__) || defined(__unix__) 
-				winsize w;
-				ioctl(STDOUT_FILENO, TIOCGWINSZ, &w);
-
-				console_size.x = w.ws_col;
-				console_size.y = w.ws_row;
-#endif
-				resize(console_size);
+				resize(getTerminalSize());
 			}
 
 			void hidePrompt()
@@ -341,7 +438,7 @@ namespace tui
 #endif
 
 #if defined(__linux__) || defined(__unix__) 
-				std::cout << term_info.civis;
+				writeOutput(getTermInfo().civis);
 #endif
 			}
 		} con;
@@ -400,12 +497,25 @@ namespace tui
 		void displayRgbiColor(bool display) { con.display_rgbi = display; }
 		bool isDisplayingRgbiColor() { return con.display_rgbi; }
 
+		void display256Color(bool display) { con.display_256 = display; }
+		bool isDisplaying256Color() { return con.display_256; }
+
 		void displayColor(bool display)
 		{
 			con.display_rgb = display;
 			con.display_rgbi = display;
+			con.display_256 = display;
 		}
-		bool isDisplayingColor() { return con.display_rgbi || con.display_rgb; }
+		bool isDisplayingColor() { return con.display_rgbi || con.display_256 || con.display_rgb; }
+
+		void useDiffDisplay(bool use)
+		{
+			con.display_diff = use;
+			con.full_redraw_needed = true;
+		}
+		bool isUsingDiffDisplay() { return con.display_diff; }
+
+		size_t getLastFrameBytes() { return con.frame_bytes; }
 
 
 		void clearDisplay()
@@ -420,7 +530,7 @@ namespace tui
 #endif
 #if defined(__linux__) || defined(__unix__) 
 			std::string str(getSize().x * getSize().y, ' ');
-			std::cout << "\033[0m" << str << term_info.home;
+			std::cout << "\033[0m" << str << getTermInfo().home;
 #endif
 		}
 
@@ -435,7 +545,7 @@ namespace tui
 #endif
 
 #if defined(__linux__) || defined(__unix__) 
-			std::cout << term_info.cvvis;
+			std::cout << getTermInfo().cvvis;
 #endif
 			clearDisplay();
 		}
@@ -447,9 +557,13 @@ namespace tui
 #endif
 			std::atexit(restore);
 
+			initTerminalSize();
+
 			con.hidePrompt();
 
-			displayRgbColor(term_info.rgb_color);
+			displayRgbColor(getTermInfo().rgb_color);
+			//256 colors only as fallback for terminals without truecolor
+			display256Color(getTermInfo().color_256 && !getTermInfo().rgb_color);
 		}
 	}
 }
\ No newline at end of file
@@ -48,7 +48,19 @@ namespace tui
 		void displayRgbiColor(bool dsiplay);
 		bool isDisplayingRgbiColor();
 
+		//xterm 256 color palette, rgb colors are approximated with 6x6x6 color cube and grayscale ramp
+		void display256Color(bool display);
+		bool isDisplaying256Color();
+
 		void displayColor(bool display);
 		bool isDisplayingColor();
+
+		/*if used only symbols changed since previous display() are written(preceded by cursor positioning),
+		whole buffer is written after resize or when enabling*/
+		void useDiffDisplay(bool use);
+		bool isUsingDiffDisplay();
+
+		//returns number of bytes written to terminal by last display(), 0 if nothing was changed
+		size_t getLastFrameBytes();
 	}
 }
\ No newline at end of file
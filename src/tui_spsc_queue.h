@@ -0,0 +1,68 @@
+//this file contains spsc_queue, lock-free queue for passing data from one thread to another
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+namespace tui
+{
+	/*single producer single consumer queue of fixed capacity(power of 2),
+	push() may be called only from one thread and pop()/drain() only from another*/
+	template<typename T, size_t capacity>
+	struct spsc_queue
+	{
+		static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0, "capacity has to be power of 2");
+	private:
+		T m_data[capacity];
+		//positions grow monotonically, index is position % capacity
+		alignas(64) std::atomic<size_t> m_head;//next element to read, written by consumer
+		alignas(64) std::atomic<size_t> m_tail;//next element to write, written by producer
+
+	public:
+		spsc_queue() : m_head(0), m_tail(0) {}
+		spsc_queue(const spsc_queue&) = delete;
+		spsc_queue& operator=(const spsc_queue&) = delete;
+
+		//returns false if queue is full
+		bool push(const T& value)
+		{
+			const size_t tail = m_tail.load(std::memory_order_relaxed);
+			if (tail - m_head.load(std::memory_order_acquire) == capacity) { return false; }
+
+			m_data[tail & (capacity - 1)] = value;
+			m_tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		//returns false if queue is empty
+		bool pop(T& value)
+		{
+			const size_t head = m_head.load(std::memory_order_relaxed);
+			if (head == m_tail.load(std::memory_order_acquire)) { return false; }
+
+			value = m_data[head & (capacity - 1)];
+			m_head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		//calls func(const T&) for every element present at the time of call and removes them, returns number of elements
+		template<typename F>
+		size_t drain(F func)
+		{
+			const size_t head = m_head.load(std::memory_order_relaxed);
+			const size_t tail = m_tail.load(std::memory_order_acquire);
+
+			for (size_t i = head; i != tail; i++)
+			{
+				func(static_cast<const T&>(m_data[i & (capacity - 1)]));
+			}
+			m_head.store(tail, std::memory_order_release);
+
+			return tail - head;
+		}
+
+		bool isEmpty() const
+		{
+			return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+		}
+	};
+}
\ No newline at end of file
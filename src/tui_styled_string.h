@@ -0,0 +1,317 @@
+//this file contains styled_string, symbol_string alternative storing style as runs
+#pragma once
+#include "tui_color.h"
+#include "tui_symbol.h"
+#include "tui_symbol_string.h"
+#include "tui_glyph_table.h"
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+namespace tui
+{
+	//style shared by style_run.length consecutive symbols starting at style_run.start
+	struct style_run
+	{
+		size_t start;
+		size_t length;
+		color Color;
+		COLOR_TRANSPARENCY color_transparency;
+		bool underscore;
+		bool inverted;
+
+		bool hasSameStyle(const style_run& other) const
+		{
+			return Color == other.Color
+				&& color_transparency == other.color_transparency
+				&& underscore == other.underscore
+				&& inverted == other.inverted;
+		}
+	};
+
+	/*text is stored once as glyph ids, style as sorted vector of runs covering whole text,
+	adjacent runs always differ, so uniformly styled text has single run,
+	restyling range is O(runs) instead of O(symbols)*/
+	struct styled_string
+	{
+	private:
+		std::vector<uint32_t> m_glyphs;
+		std::vector<style_run> m_runs;
+
+		color m_selected_color;
+		bool m_underscore = false;
+
+		static style_run getStyle(const symbol& sym)
+		{
+			return { 0, 0, sym.getColor(), sym.getColorTransparency(), sym.isUnderscore(), sym.isInverted() };
+		}
+
+		//index of run containing symbol at pos
+		size_t findRun(size_t pos) const
+		{
+			auto it = std::upper_bound(m_runs.begin(), m_runs.end(), pos, [](size_t p, const style_run& r)
+			{
+				return p < r.start;
+			});
+			return it - m_runs.begin() - 1;
+		}
+
+		//ensures that run begins at pos, returns its index
+		size_t splitRun(size_t pos)
+		{
+			if (pos >= m_glyphs.size()) { return m_runs.size(); }
+
+			const size_t i = findRun(pos);
+			if (m_runs[i].start == pos) { return i; }
+
+			style_run r = m_runs[i];
+			r.length = m_runs[i].start + m_runs[i].length - pos;
+			r.start = pos;
+			m_runs[i].length -= r.length;
+			m_runs.insert(m_runs.begin() + i + 1, r);
+			return i + 1;
+		}
+
+		//merges equally styled neighbours among runs [first - 1, last]
+		void mergeRuns(size_t first, size_t last)
+		{
+			first = first > 0 ? first - 1 : 0;
+			last = std::min(last, m_runs.size() - 1);
+
+			size_t dst = first;
+			for (size_t i = first + 1; i <= last; i++)
+			{
+				if (m_runs[dst].hasSameStyle(m_runs[i])) { m_runs[dst].length += m_runs[i].length; }
+				else { m_runs[++dst] = m_runs[i]; }
+			}
+			m_runs.erase(m_runs.begin() + dst + 1, m_runs.begin() + last + 1);
+		}
+
+		template<typename F>
+		void restyle(size_t start, size_t length, F func)
+		{
+			if (start >= m_glyphs.size() || length == 0) { return; }
+			length = std::min(length, m_glyphs.size() - start);
+
+			const size_t first = splitRun(start);
+			const size_t last = splitRun(start + length);//one past
+
+			for (size_t i = first; i < last; i++) { func(m_runs[i]); }
+
+			mergeRuns(first, last);
+		}
+
+		void appendRun(style_run style, size_t length)
+		{
+			if (length == 0) { return; }
+
+			//glyphs are already appended
+			if (m_runs.size() > 0 && m_runs.back().hasSameStyle(style))
+			{
+				m_runs.back().length += length;
+				return;
+			}
+			style.start = m_glyphs.size() - length;
+			style.length = length;
+			m_runs.push_back(style);
+		}
+
+	public:
+		styled_string() {}
+		styled_string(const symbol_string& str) { *this += str; }
+		styled_string(const char* str, color Color = color(), COLOR_TRANSPARENCY c_t = COLOR_TRANSPARENCY::NONE)
+		{
+			appendUtf8(str, std::strlen(str), Color, c_t);
+		}
+		styled_string(const std::string& str, color Color = color(), COLOR_TRANSPARENCY c_t = COLOR_TRANSPARENCY::NONE)
+		{
+			appendUtf8(str.data(), str.size(), Color, c_t);
+		}
+
+		size_t size() const { return m_glyphs.size(); }
+		bool empty() const { return m_glyphs.empty(); }
+		void clear()
+		{
+			m_glyphs.clear();
+			m_runs.clear();
+		}
+
+		const std::vector<style_run>& getRuns() const { return m_runs; }
+
+		//O(log runs)
+		symbol operator[](size_t i) const
+		{
+			const style_run& r = m_runs[findRun(i)];
+
+			symbol sym;
+			sym.setGlyph(m_glyphs[i]);
+			sym.setColor(r.Color);
+			sym.setColorTransparency(r.color_transparency);
+			sym.setUnderscore(r.underscore);
+			sym.setInversion(r.inverted);
+			return sym;
+		}
+
+		//appends whole utf8 text as single run, text is segmented in single pass
+		void appendUtf8(const char* str, size_t len, color Color = color(), COLOR_TRANSPARENCY c_t = COLOR_TRANSPARENCY::NONE)
+		{
+			const size_t old_size = m_glyphs.size();
+
+			symbol sym;
+			for (const auto& c : grapheme_segmenter(str, len))
+			{
+				sym.setCluster(str, c);
+				m_glyphs.push_back(sym.getGlyph());
+			}
+			appendRun({ 0, 0, Color, c_t, false, false }, m_glyphs.size() - old_size);
+		}
+
+		styled_string& operator+=(const symbol_string& other)
+		{
+			m_glyphs.reserve(m_glyphs.size() + other.size());
+			for (const auto& sym : other)
+			{
+				m_glyphs.push_back(sym.getGlyph());
+				appendRun(getStyle(sym), 1);
+			}
+			return *this;
+		}
+
+		styled_string& operator+=(const styled_string& other)
+		{
+			const size_t offset = m_glyphs.size();
+			m_glyphs.insert(m_glyphs.end(), other.m_glyphs.begin(), other.m_glyphs.end());
+			for (const auto& r : other.m_runs)
+			{
+				style_run shifted = r;
+				shifted.start += offset;
+				if (m_runs.size() > 0 && m_runs.back().hasSameStyle(shifted)) { m_runs.back().length += r.length; }
+				else { m_runs.push_back(shifted); }
+			}
+			return *this;
+		}
+
+		styled_string& operator<<(color color)
+		{
+			m_selected_color = color;
+			return *this;
+		}
+
+		styled_string& operator<<(ATTRIBUTE attr)
+		{
+			switch (attr)
+			{
+			case ATTRIBUTE::UNDERSCORE:
+				m_underscore = true;
+				break;
+			case ATTRIBUTE::NO_UNDERSCORE:
+				m_underscore = false;
+			}
+
+			return *this;
+		}
+
+		//appends text with selected color and underscore, as in symbol_string
+		styled_string& operator<<(const symbol_string& other)
+		{
+			m_glyphs.reserve(m_glyphs.size() + other.size());
+			for (const auto& sym : other)
+			{
+				m_glyphs.push_back(sym.getGlyph());
+				//symbols keep their transparency and inversion
+				appendRun({ 0, 0, m_selected_color, sym.getColorTransparency(), m_underscore, sym.isInverted() }, 1);
+			}
+			return *this;
+		}
+
+		void setSelectedColor(color Color) { m_selected_color = Color; }
+		void setSelectedUnderscore(bool underscore) { m_underscore = underscore; }
+
+		color getSelectedColor() const { return m_selected_color; }
+		bool isSelectedUnderscore() const { return m_underscore; }
+
+		//following functions affect length symbols starting at start, O(runs)
+		void setColor(size_t start, size_t length, color Color)
+		{
+			restyle(start, length, [&](style_run& r) { r.Color = Color; });
+		}
+		void setColorTransparency(size_t start, size_t length, COLOR_TRANSPARENCY c_t)
+		{
+			restyle(start, length, [&](style_run& r) { r.color_transparency = c_t; });
+		}
+		void setUnderscore(size_t start, size_t length, bool set)
+		{
+			restyle(start, length, [&](style_run& r) { r.underscore = set; });
+		}
+		void invert(size_t start, size_t length)
+		{
+			restyle(start, length, [&](style_run& r) { r.inverted = !r.inverted; });
+		}
+
+		void setColor(color Color) { setColor(0, size(), Color); }
+		void setColorTransparency(COLOR_TRANSPARENCY c_t) { setColorTransparency(0, size(), c_t); }
+		void setUnderscore(bool set) { setUnderscore(0, size(), set); }
+		void invert() { invert(0, size()); }
+
+		//returns number of columns occupied by string
+		size_t getWidth() const
+		{
+			size_t w = 0;
+			for (uint32_t g : m_glyphs)
+			{
+				w += getGlyphTable().getGlyph(g).width;
+			}
+			return w;
+		}
+
+		std::string getStdString() const
+		{
+			std::string str;
+			for (uint32_t g : m_glyphs)
+			{
+				str += getGlyphTable().getGlyph(g).cluster;
+			}
+			return str;
+		}
+
+		//converts to per symbol representation
+		symbol_string getSymbolString() const
+		{
+			symbol_string str;
+			str.resize(m_glyphs.size());
+
+			for (const auto& r : m_runs)
+			{
+				for (size_t i = r.start; i < r.start + r.length; i++)
+				{
+					symbol& sym = str[i];
+					sym.setGlyph(m_glyphs[i]);
+					sym.setColor(r.Color);
+					sym.setColorTransparency(r.color_transparency);
+					sym.setUnderscore(r.underscore);
+					sym.setInversion(r.inverted);
+				}
+			}
+			return str;
+		}
+
+		bool operator==(const styled_string& other) const
+		{
+			if (m_glyphs != other.m_glyphs || m_runs.size() != other.m_runs.size()) { return false; }
+			for (size_t i = 0; i < m_runs.size(); i++)
+			{
+				if (m_runs[i].start != other.m_runs[i].start
+					|| m_runs[i].length != other.m_runs[i].length
+					|| !m_runs[i].hasSameStyle(other.m_runs[i]))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+		bool operator!=(const styled_string& other) const { return !operator==(other); }
+	};
+}
\ No newline at end of file
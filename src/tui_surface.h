@@ -3,6 +3,7 @@ struct surface_size - describes size of surface
 struct surface1D_size - describes size of surface1D<DIRECTION>
 struct surface_position - describes position of surface
 struct anchor_position - describes position of anchor
+struct row_span - describes range of columns in a single row
 struct surface - surface, could be viewed as array of symbols
 struct surface1D<DIRECTION> - acts as an overlay on top of surface
 enums: POSITION, SIDE, DIRECTION
@@ -10,9 +11,12 @@ enums: POSITION, SIDE, DIRECTION
 #pragma once
 #include "tui_vec2.h"
 #include "tui_text_utils.h"
+#include "tui_symbol_grid.h"
+#include "tui_blit.h"
 
 #include <vector>
 #include <cmath>
+#include <algorithm>
 #include <functional>
 
 namespace tui
@@ -66,11 +70,39 @@ namespace tui
 			: side(side), position(position), offset(offset) {}
 	};
 
+	struct row_span
+	{
+		int begin;
+		int end;//one past last column
+
+		row_span(int begin = 0, int end = 0) : begin(begin), end(end) {}
+
+		bool isEmpty() const { return begin >= end; }
+
+		void extend(int b, int e)
+		{
+			if (isEmpty())
+			{
+				begin = b;
+				end = e;
+			}
+			else
+			{
+				begin = std::min(begin, b);
+				end = std::max(end, e);
+			}
+		}
+	};
+
 	struct surface
 	{
 	private:
-		std::vector<symbol> m_symbols;
+		symbol_grid m_grid;
 		unsigned int m_width = 1;
+
+		//columns modified since last clearDirty(), one span per row
+		std::vector<row_span> m_dirty_rows;
+		bool m_dirty = true;
 		surface_position m_position_info;
 		vec2i m_position;
 		vec2i m_global_position;
@@ -96,8 +128,10 @@ namespace tui
 				if (size.x < 1) { new_size.x = 1; }
 				if (size.y < 1) { new_size.y = 1; }
 
-				m_symbols.resize(new_size.x * new_size.y);
+				m_grid.resize(new_size.x * new_size.y);
 				m_width = new_size.x;
+				m_dirty_rows.resize(new_size.y);
+				markDirty();
 
 				clear();
 				resizeAction();
@@ -125,13 +159,15 @@ namespace tui
 			size_t x;
 			array_proxy(T* s, size_t x) : surf(s), x(x) {}
 		public:
-			symbol& operator[](size_t y)
+			symbol_ref operator[](size_t y)
 			{
-				return surf->m_symbols[surf->m_width * y + x];
+				//reference may be used for modification
+				surf->markDirty(x, y, x + 1);
+				return symbol_ref(surf->m_grid, surf->m_width * y + x);
 			}
-			const symbol& operator[](size_t y) const
+			const_symbol_ref operator[](size_t y) const
 			{
-				return surf->m_symbols[surf->m_width * y + x];
+				return const_symbol_ref(surf->m_grid, surf->m_width * y + x);
 			}
 		};
 
@@ -206,6 +242,80 @@ namespace tui
 		{
 			fill(m_clear_symbol);
 		}
+
+		void setCellAt(const symbol_grid::cell& c, vec2i position)
+		{
+			const size_t i = position.y * m_width + position.x;
+			if (!m_grid.isEqual(i, c))
+			{
+				m_grid.setCell(i, c);
+				markDirty(position.x, position.y, position.x + 1);
+			}
+		}
+
+		//insertSymbolAt() operating on packed symbol
+		void insertCellAt(
+			const symbol_grid::cell& c,
+			vec2i position,
+			color_override c_override,
+			color_transparency_override c_t_override
+		)
+		{
+			if (glyph_table::isTransparent(c.glyph)) { return; }//fully transparent, ignore
+
+			uint32_t n_fg = c.foreground;
+			uint32_t n_bg = c.background;
+			if (c_override.use)
+			{
+				switch (c_override.foreground)
+				{
+				case -1:
+					n_fg = symbol_grid::packRgb(c_override.value.foreground);
+					n_bg = symbol_grid::packRgb(c_override.value.background);
+					break;
+				case 0:
+					n_bg = symbol_grid::packRgb(c_override.value.background);
+					break;
+				case 1:
+					n_fg = symbol_grid::packRgb(c_override.value.foreground);
+				}
+			}
+
+			const size_t i = position.y * m_width + position.x;
+
+			uint8_t n_transparency_val = c_t_override.use ? static_cast<uint8_t>(c_t_override.value) : c.attributes & symbol_grid::TRANSPARENCY_MASK;
+			uint8_t o_transparency_val = m_grid.attributes[i] & symbol_grid::TRANSPARENCY_MASK;
+
+			switch (static_cast<COLOR_TRANSPARENCY>(n_transparency_val))
+			{
+			case COLOR_TRANSPARENCY::NONE:
+				break;
+			case COLOR_TRANSPARENCY::BG:
+				n_bg = m_grid.backgrounds[i];
+				break;
+			case COLOR_TRANSPARENCY::FG:
+				n_fg = m_grid.foregrounds[i];
+				break;
+			case COLOR_TRANSPARENCY::BG_FG:
+				n_fg = m_grid.foregrounds[i];
+				n_bg = m_grid.backgrounds[i];
+			}
+
+			uint8_t n_attributes = (c.attributes & ~symbol_grid::TRANSPARENCY_MASK) | (n_transparency_val & o_transparency_val);
+
+			setCellAt({ c.glyph, n_fg, n_bg, n_attributes }, position);
+		}
+
+		void markDirty(int x_begin, int y, int x_end)
+		{
+			m_dirty_rows[y].extend(x_begin, x_end);
+			m_dirty = true;
+		}
+		void markDirty()
+		{
+			for (auto& r : m_dirty_rows) { r = row_span(0, m_width); }
+			m_dirty = true;
+		}
 	public:
 		surface(surface_size size = {{ 1,1 }, { 0,0 }})
 		{
@@ -234,8 +344,8 @@ namespace tui
 
 		bool isResized() const { return m_resized; }
 
-		void setSymbolAt(const symbol& character, vec2i position) { m_symbols[position.y * m_width + position.x] = character; }
-		symbol getSymbolAt(vec2i position) const { return m_symbols[position.y * m_width + position.x]; }
+		void setSymbolAt(const symbol& character, vec2i position) { setCellAt(symbol_grid::pack(character), position); }
+		symbol getSymbolAt(vec2i position) const { return symbol_grid::unpack(m_grid.getCell(position.y * m_width + position.x)); }
 
 		void move(vec2i offset)
 		{
@@ -273,7 +383,23 @@ namespace tui
 		}
 		surface_size getSizeInfo() const { return m_size_info; }
 
-		vec2i getSize() const { return vec2i(m_width, m_symbols.size() / m_width); }
+		vec2i getSize() const { return vec2i(m_width, m_grid.size() / m_width); }
+
+		//read only access to underlying storage, symbols are stored in row-major order
+		const symbol_grid& getSymbolGrid() const { return m_grid; }
+
+		//is any symbol modified since last clearDirty()
+		bool isDirty() const { return m_dirty; }
+		//returns columns of given row modified since last clearDirty()
+		row_span getDirtySpan(int y) const { return m_dirty_rows[y]; }
+		void clearDirty()
+		{
+			if (m_dirty)
+			{
+				for (auto& r : m_dirty_rows) { r = row_span(); }
+				m_dirty = false;
+			}
+		}
 
 		void setSizeFunction(std::function<vec2i()> f_size) { m_custom_size = f_size; }
 		std::function<vec2i()> getSizeFunction() const { return m_custom_size; }
@@ -384,55 +510,9 @@ namespace tui
 			vec2i position,
 			color_override c_override,
 			color_transparency_override c_t_override
-		) 
-		{  
-			if (sym[0] != 0)//fully transparent, ignore
-			{
-				color n_color;
-				switch (c_override.use)
-				{
-				case true:
-					switch (c_override.foreground)
-					{
-					case -1:
-						n_color = c_override.value;
-						break;
-					case 0:
-						n_color = color{ sym.getColor().foreground, c_override.value.background };
-						break;
-					case 1:
-						n_color = color{ c_override.value.foreground, sym.getColor().background };
-					}
-					break;
-				case false:
-					n_color = sym.getColor();
-				}
-
-				color o_color = (*this)[position.x][position.y].getColor();
-
-				COLOR_TRANSPARENCY n_transparency = c_t_override.use ? c_t_override.value : sym.getColorTransparency();
-				uint8_t n_transparency_val = static_cast<uint8_t>(n_transparency);
-				uint8_t o_transparency_val = static_cast<uint8_t>((*this)[position.x][position.y].getColorTransparency());
-
-				switch (n_transparency)
-				{
-				case COLOR_TRANSPARENCY::NONE:
-					break;
-				case COLOR_TRANSPARENCY::BG:
-					n_color.background = o_color.background;
-					break;
-				case COLOR_TRANSPARENCY::FG:
-					n_color.foreground = o_color.foreground;
-					break;
-				case COLOR_TRANSPARENCY::BG_FG:
-					n_color = o_color;
-				}
-				symbol s = sym;
-				s.setColor(n_color);
-				s.setColorTransparency(static_cast<COLOR_TRANSPARENCY>(n_transparency_val & o_transparency_val));
-
-				setSymbolAt(s, position);
-			}
+		)
+		{
+			insertCellAt(symbol_grid::pack(sym), position, c_override, c_t_override);
 		}
 
 
@@ -463,18 +543,51 @@ namespace tui
 				if (update) { surf.updateAction(); }
 				surf.drawAction({ this, c_override, c_t_override });
 
+				//part of surf visible inside this surface
 				const vec2i origin = surf.m_position;
-				for (int y = 0; y < surf.getSize().y; y++)
+				const vec2i begin = { std::max(0, -origin.x), std::max(0, -origin.y) };
+				const vec2i end = {
+					std::min(surf.getSize().x, getSize().x - origin.x),
+					std::min(surf.getSize().y, getSize().y - origin.y)
+				};
+
+				if (begin.x >= end.x || begin.y >= end.y) { return; }
+
+				//overrides are fixed for whole call, kernel specialised for them is selected once
+				uint8_t c_mask = 0;
+				if (c_override.use)
 				{
-					for (int x = 0; x < surf.getSize().x; x++)
+					switch (c_override.foreground)
 					{
-						if (origin.x + x >= 0
-							&& origin.y + y >= 0
-							&& origin.x + x < getSize().x
-							&& origin.y + y < getSize().y)
-						{
-							insertSymbolAt(surf[x][y], origin+vec2i{ x,y }, c_override, c_t_override);
-						}
+					case -1:
+						c_mask = blit::FG | blit::BG;
+						break;
+					case 0:
+						c_mask = blit::BG;
+						break;
+					case 1:
+						c_mask = blit::FG;
+					}
+				}
+				const uint8_t t = c_t_override.use ? static_cast<uint8_t>(c_t_override.value) : blit::SOURCE_TRANSPARENCY;
+
+				const blit::kernel kernel = blit::getKernel(c_mask, t);
+				const uint32_t c_fg = symbol_grid::packRgb(c_override.value.foreground);
+				const uint32_t c_bg = symbol_grid::packRgb(c_override.value.background);
+
+				const int count = end.x - begin.x;
+				for (int y = begin.y; y < end.y; y++)
+				{
+					const size_t src_i = y * surf.m_width + begin.x;
+					const size_t dst_i = (origin.y + y) * m_width + origin.x + begin.x;
+
+					int changed_begin = count;
+					int changed_end = 0;
+					kernel(m_grid, dst_i, surf.m_grid, src_i, count, c_fg, c_bg, changed_begin, changed_end);
+
+					if (changed_begin < changed_end)
+					{
+						markDirty(origin.x + begin.x + changed_begin, origin.y + y, origin.x + begin.x + changed_end);
 					}
 				}
 			}
@@ -482,7 +595,18 @@ namespace tui
 
 		void fill(const symbol& Symbol)
 		{
-			for (int i = 0; i < m_symbols.size(); i++) { m_symbols[i] = Symbol; }
+			const symbol_grid::cell c = symbol_grid::pack(Symbol);
+
+			for (size_t y = 0; y < m_dirty_rows.size(); y++)
+			{
+				const size_t row = y * m_width;
+				const std::pair<size_t, size_t> changed = m_grid.fill(row, row + m_width, c);
+
+				if (changed.first != changed.second)
+				{
+					markDirty(changed.first - row, y, changed.second - row);
+				}
+			}
 		}
 		void makeTransparent() 
 		{
@@ -492,12 +616,18 @@ namespace tui
 
 		void fillColorTransparency(COLOR_TRANSPARENCY c_t)
 		{
-			for (int i = 0; i < m_symbols.size(); i++) { m_symbols[i].setColorTransparency(c_t); }
+			for (auto& a : m_grid.attributes)
+			{
+				a = (a & ~symbol_grid::TRANSPARENCY_MASK) | static_cast<uint8_t>(c_t);
+			}
+			markDirty();
 		}
 
 		void fillColor(color c)
 		{
-			for (int i = 0; i < m_symbols.size(); i++) { m_symbols[i].setColor(c); }
+			std::fill(m_grid.foregrounds.begin(), m_grid.foregrounds.end(), symbol_grid::packRgb(c.foreground));
+			std::fill(m_grid.backgrounds.begin(), m_grid.backgrounds.end(), symbol_grid::packRgb(c.background));
+			markDirty();
 		}
 
 		void setClearSymbol(const symbol& sym) { m_clear_symbol = sym; }
@@ -505,7 +635,8 @@ namespace tui
 
 		void invert()
 		{
-			for (int i = 0; i < m_symbols.size(); i++) { m_symbols[i].invert(); }
+			for (auto& a : m_grid.attributes) { a ^= symbol_grid::INVERTED; }
+			markDirty();
 		}
 	};
 
@@ -565,7 +696,7 @@ namespace tui
 				return surface::getSymbolAt({ 0, position });
 			}
 		}
-		symbol& operator[](size_t i)
+		symbol_ref operator[](size_t i)
 		{
 			switch (direction)
 			{
@@ -575,7 +706,7 @@ namespace tui
 				return surface::operator[](0)[i];
 			}
 		}
-		const symbol& operator[](size_t i) const 
+		const_symbol_ref operator[](size_t i) const 
 		{
 			switch (direction)
 			{
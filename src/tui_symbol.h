@@ -2,9 +2,12 @@
 #pragma once
 #include "tui_unicode_utils.h"
 #include "tui_color.h"
+#include "tui_glyph_table.h"
+#include "tui_cluster_cache.h"
 
 #include <algorithm>
 #include <string>
+#include <type_traits>
 
 namespace tui
 {
@@ -19,160 +22,20 @@ namespace tui
 	struct symbol
 	{
 	private:
-
-		//stores small amount of data in place of pointer
-		struct hybrid_container
-		{
-		private:
-			constexpr static unsigned int stack_size = sizeof(char*);
-
-#ifndef TUI_DISABLE_MEMBER_PACKING
-#pragma pack(push,1)
-#endif
-			union
-			{
-				char m_stack[stack_size];
-				char* m_heap;
-			};
-			uint8_t m_size = 0;
-#ifndef TUI_DISABLE_MEMBER_PACKING
-#pragma pack(pop)
-#endif
-
-			bool isStack() const { return m_size <= stack_size; }
-			bool isHeap() const { return !isStack(); }
-
-			void clearStack()
-			{
-				m_heap = 0;
-			}
-
-			void setStackData(const char* data, uint8_t size)
-			{
-				if (isHeap()) { delete[] m_heap; }
-
-				clearStack();
-
-				for (int i = 0; i < size; i++)
-				{
-					m_stack[i] = data[i];
-				}
-				m_size = size;
-			}
-			void setHeapData(const char* data, uint8_t size)
-			{
-				if (isStack()) { m_heap = new char[size]; }
-
-				if (isHeap() && m_size != size)
-				{
-					delete[] m_heap;
-					m_heap = new char[size];
-				}
-
-				for (int i = 0; i < size; i++)
-				{
-					m_heap[i] = data[i];
-				}
-				m_size = size;
-			}
-		public:
-			hybrid_container()
-			{
-				clearStack();
-			}
-			hybrid_container(const hybrid_container& other)
-			{
-				setData(other.getData(), other.size());
-			}
-			~hybrid_container()
-			{
-				if (isHeap()) { delete[] m_heap; }
-			}
-
-			hybrid_container& operator=(const hybrid_container& other)
-			{
-				if (this != &other)
-				{
-					setData(other.getData(), other.size());
-				}
-				return *this;
-			}
-
-			uint8_t size() const { return m_size; }
-
-			const char* getData() const
-			{
-				switch (isStack())
-				{
-				case true:
-					return m_stack;
-				case false:
-					return m_heap;
-				}
-			}
-
-			void setData(const char* data, uint8_t size)
-			{
-				switch (size <= stack_size)
-				{
-				case true:
-					setStackData(data, size);
-					break;
-				case false:
-					setHeapData(data, size);
-				}
-			}
-
-			bool operator==(const hybrid_container& other) const
-			{
-				if (size() != other.size()) { return false; }
-
-				for (int i = 0; i < size(); i++)
-				{
-					if (getData()[i] != other.getData()[i])
-					{
-						return false;
-					}
-				}
-				return true;
-			}
-			bool operator!=(const hybrid_container& other) const { return !operator==(other); }
-		} m_cluster;
-
+		uint32_t m_glyph = glyph_table::EMPTY;
 		uint8_t m_width : 4;
 		uint8_t m_color_transparency : 2;
 		bool m_inverted : 1;
 		bool m_underscore : 1;
 		color m_color;
 
-		uint8_t getClusterWidth(const std::u32string& u32_s) const
+		//c - cluster found at the beginning of str
+		static uint32_t getClusterId(const char* str, const grapheme_cluster& c)
 		{
-			//probably broken here and there
-
-			if (u32_s.size() == 0 || isControl(u32_s[0]))
-			{
-				return 0;
-			}
-
-			uint8_t w = 0;
-
-			for (int i = 0; i < u32_s.size(); i++)
-			{
-				uint8_t c_w = 0;
-
-				if (isWide(u32_s[i]))
-				{
-					c_w = 2;
-				}
-				else if (getGraphemeType(u32_s[i]) != GRAPHEME_TYPE::EXTEND)
-				{
-					c_w = 1;
-				}
-
-				w = std::max(w, c_w);
-			}
+			if (c.valid) { return getGlyphTable().getId(str, c.length, c.width); }
 
-			return w;
+			std::string valid = utf32ToUtf8(utf8ToUtf32(str, c.length));
+			return getGlyphTable().getId(valid.data(), valid.size(), c.width);
 		}
 
 	public:
@@ -192,43 +55,63 @@ namespace tui
 			setColor(Color);
 		}
 
-		uint8_t size() const { return m_cluster.size(); }
+		uint8_t size() const { return getGlyphTable().getGlyph(m_glyph).cluster.size(); }
 
 		const char& operator[](int i) const
 		{
-			return m_cluster.getData()[i];
+			return getGlyphTable().getGlyph(m_glyph).cluster[i];
 		}
 
-		void setCluster(const std::string& cluster)
+		void setCluster(const std::string& cluster) { setCluster(cluster.data(), cluster.size()); }
+		//only first grapheme cluster is used, invalid sequences are replaced by U+FFFD
+		void setCluster(const char* cluster, size_t size)
 		{
-			if (cluster.size() == 0)
+			if (size == 0)
 			{
-				m_cluster.setData(nullptr, 0);
 				m_width = 0;
+				m_glyph = glyph_table::EMPTY;
 				return;
 			}
-
-			std::u32string utf32_cluster = utf8ToUtf32(cluster);
-			unsigned int size = 1;
-
-			for (; size < utf32_cluster.size(); size++)
+			if (size == 1 && glyph_table::isAscii(cluster[0]))
 			{
-				if (isBreakBetween(utf32_cluster[size - 1], utf32_cluster[size]))
-				{
-					break;
-				}
+				setGlyph(glyph_table::getAsciiId(cluster[0]));
+				return;
 			}
 
-			utf32_cluster.resize(size);
+			uint32_t id;
+			if (getClusterCache().find(cluster, size, id))
+			{
+				setGlyph(id);
+				return;
+			}
 
-			std::string new_cluster = utf32ToUtf8(utf32_cluster);
-			m_cluster.setData(new_cluster.data(), new_cluster.size());
+			id = getClusterId(cluster, *grapheme_iterator(cluster, size));
 
-			m_width = getClusterWidth(utf32_cluster);
+			setGlyph(id);
+			getClusterCache().insert(cluster, size, id);
 		}
+		//sets cluster found in str by grapheme_iterator, cluster is not segmented and validated again
+		void setCluster(const char* str, const grapheme_cluster& c)
+		{
+			const char* cluster = str + c.offset;
+			if (c.length == 1 && glyph_table::isAscii(cluster[0]))
+			{
+				setGlyph(glyph_table::getAsciiId(cluster[0]));
+				return;
+			}
+			setGlyph(getClusterId(cluster, c));
+		}
+		//sets cluster by its glyph_table id
+		void setGlyph(uint32_t id)
+		{
+			m_width = getGlyphTable().getGlyph(id).width;
+			m_glyph = id;
+		}
+		uint32_t getGlyph() const { return m_glyph; }
+
 		std::string getCluster() const
 		{
-			return std::string(m_cluster.getData(), m_cluster.size());
+			return getGlyphTable().getGlyph(m_glyph).cluster;
 		}
 
 		void invert() { m_inverted = !m_inverted; }
@@ -252,7 +135,7 @@ namespace tui
 
 		bool operator==(const symbol& other) const
 		{
-			return m_cluster == other.m_cluster 
+			return m_glyph == other.m_glyph
 				&& m_color == other.m_color 
 				&& m_color_transparency == other.m_color_transparency
 				&& m_underscore == other.m_underscore
@@ -260,4 +143,7 @@ namespace tui
 		}
 		bool operator!=(const symbol& other) const { return !operator==(other); }
 	};
+
+	//cluster is owned by glyph_table, copying symbol never allocates
+	static_assert(std::is_trivially_copyable<symbol>::value, "symbol must be trivially copyable");
 }
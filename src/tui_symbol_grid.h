@@ -0,0 +1,227 @@
+/*this file contains following elements:
+struct symbol_grid - row-major storage of symbols split into separate arrays, used by surface
+struct symbol_reference<T> - refers to single symbol of symbol_grid, acts like symbol
+*/
+#pragma once
+#include "tui_symbol.h"
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+
+namespace tui
+{
+	struct symbol_grid
+	{
+		//layout of attributes byte
+		enum ATTRIBUTE_BIT : uint8_t
+		{
+			TRANSPARENCY_MASK = 0b11,
+			INVERTED = 0b100,
+			UNDERSCORE = 0b1000,
+			WIDTH_SHIFT = 4
+		};
+
+		//packed value of single symbol
+		struct cell
+		{
+			uint32_t glyph;
+			uint32_t foreground;
+			uint32_t background;
+			uint8_t attributes;
+
+			bool operator==(const cell& other) const
+			{
+				return glyph == other.glyph
+					&& foreground == other.foreground
+					&& background == other.background
+					&& attributes == other.attributes;
+			}
+			bool operator!=(const cell& other) const { return !operator==(other); }
+		};
+
+		std::vector<uint32_t> glyphs;
+		std::vector<uint32_t> foregrounds;//0x00RRGGBB
+		std::vector<uint32_t> backgrounds;//0x00RRGGBB
+		std::vector<uint8_t> attributes;
+
+		static uint32_t packRgb(rgb c) { return uint32_t(c.r) << 16 | uint32_t(c.g) << 8 | c.b; }
+		static rgb unpackRgb(uint32_t c) { return rgb(c >> 16, (c >> 8) & 0xFF, c & 0xFF); }
+
+		static cell pack(const symbol& sym)
+		{
+			cell c;
+			c.glyph = sym.getGlyph();
+			c.foreground = packRgb(sym.getColor().foreground);
+			c.background = packRgb(sym.getColor().background);
+			c.attributes = static_cast<uint8_t>(sym.getColorTransparency())
+				| (sym.isInverted() ? INVERTED : 0)
+				| (sym.isUnderscore() ? UNDERSCORE : 0)
+				| sym.getWidth() << WIDTH_SHIFT;
+			return c;
+		}
+		static symbol unpack(const cell& c)
+		{
+			symbol sym;
+			sym.setGlyph(c.glyph);
+			sym.setColor({ unpackRgb(c.foreground), unpackRgb(c.background) });
+			sym.setColorTransparency(static_cast<COLOR_TRANSPARENCY>(c.attributes & TRANSPARENCY_MASK));
+			sym.setInversion(c.attributes & INVERTED);
+			sym.setUnderscore(c.attributes & UNDERSCORE);
+			return sym;
+		}
+
+		size_t size() const { return glyphs.size(); }
+
+		void resize(size_t size)
+		{
+			glyphs.resize(size);
+			foregrounds.resize(size);
+			backgrounds.resize(size);
+			attributes.resize(size);
+		}
+
+		cell getCell(size_t i) const
+		{
+			return { glyphs[i], foregrounds[i], backgrounds[i], attributes[i] };
+		}
+		void setCell(size_t i, const cell& c)
+		{
+			glyphs[i] = c.glyph;
+			foregrounds[i] = c.foreground;
+			backgrounds[i] = c.background;
+			attributes[i] = c.attributes;
+		}
+
+		bool isEqual(size_t i, const cell& c) const
+		{
+			return glyphs[i] == c.glyph
+				&& foregrounds[i] == c.foreground
+				&& backgrounds[i] == c.background
+				&& attributes[i] == c.attributes;
+		}
+
+		/*sets symbols from [begin, end) to c, returns range of changed symbols(empty range if nothing was changed),
+		only part between first and last changed symbol is written, each array is filled separately*/
+		std::pair<size_t, size_t> fill(size_t begin, size_t end, const cell& c)
+		{
+			size_t first = begin;
+			while (first < end && isEqual(first, c)) { first++; }
+
+			if (first == end) { return { end, end }; }
+
+			size_t last = end;
+			while (isEqual(last - 1, c)) { last--; }
+
+			std::fill(glyphs.begin() + first, glyphs.begin() + last, c.glyph);
+			std::fill(foregrounds.begin() + first, foregrounds.begin() + last, c.foreground);
+			std::fill(backgrounds.begin() + first, backgrounds.begin() + last, c.background);
+			std::fill(attributes.begin() + first, attributes.begin() + last, c.attributes);
+
+			return { first, last };
+		}
+	};
+
+	//T is symbol_grid or const symbol_grid, reference to const grid allows only reading
+	template<typename T>
+	struct symbol_reference
+	{
+		template<typename> friend struct symbol_reference;
+	private:
+		T* m_grid;
+		size_t m_idx;
+
+		const glyph& getGlyphData() const { return getGlyphTable().getGlyph(m_grid->glyphs[m_idx]); }
+
+		void setAttribute(uint8_t bit, bool set)
+		{
+			if (set) { m_grid->attributes[m_idx] |= bit; }
+			else { m_grid->attributes[m_idx] &= ~bit; }
+		}
+	public:
+		symbol_reference(T& grid, size_t idx) : m_grid(&grid), m_idx(idx) {}
+		//allows conversion of reference to reference to const
+		template<typename Y>
+		symbol_reference(const symbol_reference<Y>& other) : m_grid(other.m_grid), m_idx(other.m_idx) {}
+		//copying proxy copies reference, assigning copies cell
+		symbol_reference(const symbol_reference&) = default;
+
+		//assigns value, not reference
+		symbol_reference& operator=(const symbol_reference& other)
+		{
+			m_grid->setCell(m_idx, other.getCell());
+			return *this;
+		}
+		template<typename Y>
+		symbol_reference& operator=(const symbol_reference<Y>& other)
+		{
+			m_grid->setCell(m_idx, other.getCell());
+			return *this;
+		}
+		symbol_reference& operator=(const symbol& sym)
+		{
+			m_grid->setCell(m_idx, symbol_grid::pack(sym));
+			return *this;
+		}
+
+		operator symbol() const { return symbol_grid::unpack(getCell()); }
+
+		symbol_grid::cell getCell() const { return m_grid->getCell(m_idx); }
+
+		uint8_t size() const { return getGlyphData().cluster.size(); }
+
+		const char& operator[](int i) const { return getGlyphData().cluster[i]; }
+
+		void setCluster(const std::string& cluster)
+		{
+			symbol sym = *this;
+			sym.setCluster(cluster);
+			*this = sym;
+		}
+		std::string getCluster() const { return getGlyphData().cluster; }
+
+		uint32_t getGlyph() const { return m_grid->glyphs[m_idx]; }
+
+		void invert() { m_grid->attributes[m_idx] ^= symbol_grid::INVERTED; }
+		void setInversion(bool set) { setAttribute(symbol_grid::INVERTED, set); }
+		bool isInverted() const { return m_grid->attributes[m_idx] & symbol_grid::INVERTED; }
+
+		void setColor(color Color)
+		{
+			m_grid->foregrounds[m_idx] = symbol_grid::packRgb(Color.foreground);
+			m_grid->backgrounds[m_idx] = symbol_grid::packRgb(Color.background);
+		}
+		color getColor() const
+		{
+			return { symbol_grid::unpackRgb(m_grid->foregrounds[m_idx]), symbol_grid::unpackRgb(m_grid->backgrounds[m_idx]) };
+		}
+
+		void setColorTransparency(COLOR_TRANSPARENCY c_t)
+		{
+			m_grid->attributes[m_idx] = (m_grid->attributes[m_idx] & ~symbol_grid::TRANSPARENCY_MASK) | static_cast<uint8_t>(c_t);
+		}
+		COLOR_TRANSPARENCY getColorTransparency() const
+		{
+			return static_cast<COLOR_TRANSPARENCY>(m_grid->attributes[m_idx] & symbol_grid::TRANSPARENCY_MASK);
+		}
+
+		void setUnderscore(bool set) { setAttribute(symbol_grid::UNDERSCORE, set); }
+		bool isUnderscore() const { return m_grid->attributes[m_idx] & symbol_grid::UNDERSCORE; }
+
+		//returns number of columns occupied by symbol
+		uint8_t getWidth() const { return m_grid->attributes[m_idx] >> symbol_grid::WIDTH_SHIFT; }
+
+		template<typename Y>
+		bool operator==(const symbol_reference<Y>& other) const { return m_grid->isEqual(m_idx, other.getCell()); }
+		template<typename Y>
+		bool operator!=(const symbol_reference<Y>& other) const { return !operator==(other); }
+
+		bool operator==(const symbol& sym) const { return m_grid->isEqual(m_idx, symbol_grid::pack(sym)); }
+		bool operator!=(const symbol& sym) const { return !operator==(sym); }
+	};
+
+	using symbol_ref = symbol_reference<symbol_grid>;
+	using const_symbol_ref = symbol_reference<const symbol_grid>;
+}
\ No newline at end of file
@@ -0,0 +1,327 @@
+//this file contains symbol_rope, sequence of symbols for large and frequently edited text
+#pragma once
+#include "tui_symbol.h"
+#include "tui_symbol_string.h"
+
+#include <memory>
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <cstdint>
+
+namespace tui
+{
+	/*balanced(AVL) tree of chunks of symbols, insert/erase/concatenation/slicing are O(log n),
+	nodes are immutable and shared, so copying and slicing do not copy symbols,
+	sequential access by index does not descend from root(last accessed chunk is remembered)*/
+	struct symbol_rope
+	{
+	private:
+		struct node;
+		using node_ptr = std::shared_ptr<const node>;
+
+		struct node
+		{
+			node_ptr left;
+			node_ptr right;
+			std::vector<symbol> symbols;//used only by leaf(node without children)
+			size_t size = 0;
+			size_t width = 0;
+			uint8_t height = 0;//leaf - 0
+
+			bool isLeaf() const { return !left; }
+		};
+
+		static constexpr size_t max_leaf = 256;
+
+		node_ptr m_root;
+
+		//leaf containing last accessed symbol and index of its first symbol
+		mutable const node* m_cached_leaf = nullptr;
+		mutable size_t m_cached_begin = 0;
+
+		static size_t getSize(const node_ptr& n) { return n ? n->size : 0; }
+		static int getHeight(const node_ptr& n) { return n ? n->height : -1; }
+
+		static node_ptr makeLeaf(std::vector<symbol> symbols)
+		{
+			if (symbols.size() == 0) { return nullptr; }
+
+			auto n = std::make_shared<node>();
+			n->size = symbols.size();
+			for (const auto& s : symbols) { n->width += s.getWidth(); }
+			n->symbols = std::move(symbols);
+			return n;
+		}
+
+		//adjacent small leaves are merged
+		static node_ptr makeNode(const node_ptr& l, const node_ptr& r)
+		{
+			if (!l) { return r; }
+			if (!r) { return l; }
+
+			if (l->isLeaf() && r->isLeaf() && l->size + r->size <= max_leaf)
+			{
+				std::vector<symbol> symbols;
+				symbols.reserve(l->size + r->size);
+				symbols.insert(symbols.end(), l->symbols.begin(), l->symbols.end());
+				symbols.insert(symbols.end(), r->symbols.begin(), r->symbols.end());
+				return makeLeaf(std::move(symbols));
+			}
+
+			auto n = std::make_shared<node>();
+			n->left = l;
+			n->right = r;
+			n->size = l->size + r->size;
+			n->width = l->width + r->width;
+			n->height = std::max(l->height, r->height) + 1;
+			return n;
+		}
+
+		//restores balance of node whose children heights differ by at most 2
+		static node_ptr balance(const node_ptr& n)
+		{
+			if (!n || n->isLeaf()) { return n; }
+
+			const int diff = getHeight(n->left) - getHeight(n->right);
+			if (diff > 1)
+			{
+				const node_ptr& l = n->left;
+				if (getHeight(l->left) >= getHeight(l->right))
+				{
+					return makeNode(l->left, makeNode(l->right, n->right));
+				}
+				return makeNode(makeNode(l->left, l->right->left), makeNode(l->right->right, n->right));
+			}
+			if (diff < -1)
+			{
+				const node_ptr& r = n->right;
+				if (getHeight(r->right) >= getHeight(r->left))
+				{
+					return makeNode(makeNode(n->left, r->left), r->right);
+				}
+				return makeNode(makeNode(n->left, r->left->left), makeNode(r->left->right, r->right));
+			}
+			return n;
+		}
+
+		//O(difference of heights)
+		static node_ptr join(const node_ptr& l, const node_ptr& r)
+		{
+			if (!l) { return r; }
+			if (!r) { return l; }
+
+			if (l->height > r->height + 1)
+			{
+				return balance(makeNode(l->left, join(l->right, r)));
+			}
+			if (r->height > l->height + 1)
+			{
+				return balance(makeNode(join(l, r->left), r->right));
+			}
+			return makeNode(l, r);
+		}
+
+		//first - symbols before i, second - rest
+		static std::pair<node_ptr, node_ptr> split(const node_ptr& n, size_t i)
+		{
+			if (!n) { return { nullptr, nullptr }; }
+			if (i == 0) { return { nullptr, n }; }
+			if (i >= n->size) { return { n, nullptr }; }
+
+			if (n->isLeaf())
+			{
+				return {
+					makeLeaf(std::vector<symbol>(n->symbols.begin(), n->symbols.begin() + i)),
+					makeLeaf(std::vector<symbol>(n->symbols.begin() + i, n->symbols.end()))
+				};
+			}
+
+			if (i <= n->left->size)
+			{
+				auto s = split(n->left, i);
+				return { s.first, join(s.second, n->right) };
+			}
+			auto s = split(n->right, i - n->left->size);
+			return { join(n->left, s.first), s.second };
+		}
+
+		//tree of height O(log n) from contiguous symbols
+		static node_ptr build(const symbol* symbols, size_t size)
+		{
+			if (size <= max_leaf) { return makeLeaf(std::vector<symbol>(symbols, symbols + size)); }
+
+			const size_t half = size / 2;
+			return makeNode(build(symbols, half), build(symbols + half, size - half));
+		}
+
+		static node_ptr replace(const node_ptr& n, size_t i, const symbol& sym)
+		{
+			if (n->isLeaf())
+			{
+				std::vector<symbol> symbols = n->symbols;
+				symbols[i] = sym;
+				return makeLeaf(std::move(symbols));
+			}
+			if (i < n->left->size) { return makeNode(replace(n->left, i, sym), n->right); }
+			return makeNode(n->left, replace(n->right, i - n->left->size, sym));
+		}
+
+		template<typename F>
+		static void forEachLeaf(const node_ptr& n, F func)
+		{
+			if (!n) { return; }
+			if (n->isLeaf())
+			{
+				func(n->symbols);
+				return;
+			}
+			forEachLeaf(n->left, func);
+			forEachLeaf(n->right, func);
+		}
+
+		void setRoot(node_ptr root)
+		{
+			m_root = std::move(root);
+			m_cached_leaf = nullptr;
+		}
+
+		explicit symbol_rope(node_ptr root) : m_root(std::move(root)) {}
+
+	public:
+		struct const_iterator
+		{
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = symbol;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const symbol*;
+			using reference = const symbol&;
+
+		private:
+			const symbol_rope* m_rope = nullptr;
+			size_t m_idx = 0;
+
+		public:
+			const_iterator() {}
+			const_iterator(const symbol_rope* rope, size_t idx) : m_rope(rope), m_idx(idx) {}
+
+			reference operator*() const { return (*m_rope)[m_idx]; }
+			pointer operator->() const { return &(*m_rope)[m_idx]; }
+
+			const_iterator& operator++()
+			{
+				m_idx++;
+				return *this;
+			}
+			const_iterator operator++(int)
+			{
+				const_iterator tmp = *this;
+				m_idx++;
+				return tmp;
+			}
+
+			bool operator==(const const_iterator& other) const { return m_idx == other.m_idx; }
+			bool operator!=(const const_iterator& other) const { return m_idx != other.m_idx; }
+
+			size_t getIndex() const { return m_idx; }
+		};
+
+		symbol_rope() {}
+		symbol_rope(const symbol_string& str) : m_root(build(str.data(), str.size())) {}
+
+		size_t size() const { return getSize(m_root); }
+		bool empty() const { return !m_root; }
+		void clear() { setRoot(nullptr); }
+
+		//returns number of columns occupied by rope, O(1)
+		size_t getWidth() const { return m_root ? m_root->width : 0; }
+
+		//O(1) if previous access was in the same chunk, otherwise O(log n)
+		const symbol& operator[](size_t i) const
+		{
+			if (m_cached_leaf == nullptr || i < m_cached_begin || i >= m_cached_begin + m_cached_leaf->size)
+			{
+				const node* n = m_root.get();
+				size_t begin = 0;
+				while (!n->isLeaf())
+				{
+					if (i < begin + n->left->size) { n = n->left.get(); }
+					else
+					{
+						begin += n->left->size;
+						n = n->right.get();
+					}
+				}
+				m_cached_leaf = n;
+				m_cached_begin = begin;
+			}
+			return m_cached_leaf->symbols[i - m_cached_begin];
+		}
+		const symbol& front() const { return (*this)[0]; }
+		const symbol& back() const { return (*this)[size() - 1]; }
+
+		const_iterator begin() const { return const_iterator(this, 0); }
+		const_iterator end() const { return const_iterator(this, size()); }
+
+		void set(size_t i, const symbol& sym) { setRoot(replace(m_root, i, sym)); }
+
+		void insert(size_t pos, const symbol_rope& rope)
+		{
+			auto s = split(m_root, pos);
+			setRoot(join(join(s.first, rope.m_root), s.second));
+		}
+		void insert(size_t pos, const symbol_string& str) { insert(pos, symbol_rope(str)); }
+		void insert(size_t pos, const symbol& sym) { insert(pos, symbol_rope(makeLeaf({ sym }))); }
+
+		void erase(size_t pos, size_t count = 1)
+		{
+			auto l = split(m_root, pos);
+			auto r = split(l.second, count);
+			setRoot(join(l.first, r.second));
+		}
+
+		void push_back(const symbol& sym) { insert(size(), sym); }
+		void pop_back() { erase(size() - 1); }
+
+		symbol_rope& operator+=(const symbol_rope& other)
+		{
+			setRoot(join(m_root, other.m_root));
+			return *this;
+		}
+
+		//returns count symbols starting at pos, shares nodes with this rope
+		symbol_rope substr(size_t pos, size_t count = static_cast<size_t>(-1)) const
+		{
+			auto l = split(m_root, pos);
+			return symbol_rope(split(l.second, count).first);
+		}
+
+		symbol_string getSymbolString() const
+		{
+			symbol_string str;
+			str.reserve(size());
+			forEachLeaf(m_root, [&](const std::vector<symbol>& symbols)
+			{
+				str.insert(str.end(), symbols.begin(), symbols.end());
+			});
+			return str;
+		}
+
+		std::string getStdString() const
+		{
+			std::string str;
+			forEachLeaf(m_root, [&](const std::vector<symbol>& symbols)
+			{
+				for (const auto& s : symbols) { str += s.getCluster(); }
+			});
+			return str;
+		}
+	};
+
+	inline symbol_rope operator+(const symbol_rope& l, const symbol_rope& r)
+	{
+		symbol_rope tmp = l;
+		return tmp += r;
+	}
+}
\ No newline at end of file
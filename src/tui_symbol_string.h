@@ -4,6 +4,7 @@
 
 #include <string>
 #include <vector>
+#include <cstring>
 
 namespace tui
 {
@@ -25,29 +26,30 @@ namespace tui
 			resize(1);
 			(*this)[0] = Symbol;
 		}
-		symbol_string(const char* str) 
-			: symbol_string(utf8ToUtf32(str)) {}
+		symbol_string(const char* str)
+		{
+			appendUtf8(str, std::strlen(str), color(), COLOR_TRANSPARENCY::NONE);
+		}
 		symbol_string(const char32_t* str) 
 			: symbol_string(std::u32string(str)) {}
 		symbol_string(const std::string& str, color color = color(), COLOR_TRANSPARENCY c_t = COLOR_TRANSPARENCY::NONE)
-			: symbol_string(utf8ToUtf32(str), color, c_t) {}
+		{
+			appendUtf8(str.data(), str.size(), color, c_t);
+		}
 		symbol_string(const std::u32string& str, color color = color(), COLOR_TRANSPARENCY c_t = COLOR_TRANSPARENCY::NONE)
+			: symbol_string(utf32ToUtf8(str), color, c_t) {}
+
+		//appends symbol for every grapheme cluster of utf8 text, text is segmented in single pass
+		void appendUtf8(const char* str, size_t len, color Color = color(), COLOR_TRANSPARENCY c_t = COLOR_TRANSPARENCY::NONE)
 		{
-			unsigned int i = 0;
-			while (i < str.size())
+			for (const auto& c : grapheme_segmenter(str, len))
 			{
-				std::u32string current_cluster;
-				current_cluster += str[i];
-
-				for (; (i < str.size() - 1 && !isBreakBetween(str[i], str[i + 1])); i++)
-				{
-					current_cluster += str[i + 1];
-				}
-				push_back(symbol(utf32ToUtf8(current_cluster), color));
-				i++;
+				push_back(symbol());
+				symbol& sym = back();
+				sym.setCluster(str, c);
+				sym.setColor(Color);
+				sym.setColorTransparency(c_t);
 			}
-
-			setColorTransparency(c_t);
 		}
 
 		using std::vector<symbol>::operator[];
@@ -64,6 +66,7 @@ namespace tui
 		using std::vector<symbol>::push_back;
 		using std::vector<symbol>::pop_back;
 		using std::vector<symbol>::resize;
+		using std::vector<symbol>::reserve;
 
 
 		symbol_string& operator<<(color color)
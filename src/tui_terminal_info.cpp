@@ -1,108 +1,89 @@
 #include "tui_terminal_info.h"
+#include "tui_terminfo.h"
 
-#include <array>
-#include <cstdio>
 #include <cmath>
 #include <algorithm>
-#include <iostream>
 #include <utility>
+#include <cstdlib>
 
 namespace tui
 {
-	terminal_info term_info;
+	TERMINAL_PROFILE terminal_profile = TERMINAL_PROFILE::AUTO;
 
 #if defined(__linux__) || defined(__unix__) 
-	std::string getCommandOutput(const char* command)
+	//used when terminfo is not read or there is no entry for terminal, taken from ncurses database
+	const std::vector<std::pair<const char*, const char*>> xterm_capabilities =
 	{
-		std::array<char, 128> buffer;
-		std::string output;
-		FILE* pipe = popen(command, "r");
-		if (pipe)
-		{
-			while (fgets(buffer.data(), buffer.size(), pipe) != NULL) {
-				output += buffer.data();
-			}
-		}
-		pclose(pipe);
-
-		return output;
-	}
+		{"kpp", "\033[5~"}, {"knp", "\033[6~"}, {"kdch1", "\033[3~"}, {"kich1", "\033[2~"}, {"kend", "\033OF"}, {"khome", "\033OH"},
+		{"kf1", "\033OP"}, {"kf2", "\033OQ"}, {"kf3", "\033OR"}, {"kf4", "\033OS"}, {"kf5", "\033[15~"}, {"kf6", "\033[17~"},
+		{"kf7", "\033[18~"}, {"kf8", "\033[19~"}, {"kf9", "\033[20~"}, {"kf10", "\033[21~"}, {"kf11", "\033[23~"}, {"kf12", "\033[24~"},
+		{"kcuu1", "\033OA"}, {"kcud1", "\033OB"}, {"kcub1", "\033OD"}, {"kcuf1", "\033OC"}, {"kPRV3", "\033[5;3~"}, {"kNXT3", "\033[6;3~"},
+		{"kDC3", "\033[3;3~"}, {"kIC3", "\033[2;3~"}, {"kEND3", "\033[1;3F"}, {"kHOM3", "\033[1;3H"}, {"kUP3", "\033[1;3A"}, {"kDN3", "\033[1;3B"},
+		{"kLFT3", "\033[1;3D"}, {"kRIT3", "\033[1;3C"}, {"kf13", "\033[1;2P"}, {"kf14", "\033[1;2Q"}, {"kf15", "\033[1;2R"}, {"kf16", "\033[1;2S"},
+		{"kf17", "\033[15;2~"}, {"kf18", "\033[17;2~"}, {"kf19", "\033[18;2~"}, {"kf20", "\033[19;2~"}, {"kf21", "\033[20;2~"}, {"kf22", "\033[21;2~"},
+		{"kf23", "\033[23;2~"}, {"kf24", "\033[24;2~"}, {"kUP", "\033[1;2A"}, {"kDN", "\033[1;2B"}, {"kLFT", "\033[1;2D"}, {"kRIT", "\033[1;2C"},
+		{"kPRV5", "\033[5;5~"}, {"kNXT5", "\033[6;5~"}, {"kDC5", "\033[3;5~"}, {"kIC5", "\033[2;5~"}, {"kEND5", "\033[1;5F"}, {"kHOM5", "\033[1;5H"},
+		{"kf25", "\033[1;5P"}, {"kf26", "\033[1;5Q"}, {"kf27", "\033[1;5R"}, {"kf28", "\033[1;5S"}, {"kf29", "\033[15;5~"}, {"kf30", "\033[17;5~"},
+		{"kf31", "\033[18;5~"}, {"kf32", "\033[19;5~"}, {"kf33", "\033[20;5~"}, {"kf34", "\033[21;5~"}, {"kf35", "\033[23;5~"}, {"kf36", "\033[24;5~"},
+		{"kUP5", "\033[1;5A"}, {"kDN5", "\033[1;5B"}, {"kLFT5", "\033[1;5D"}, {"kRIT5", "\033[1;5C"}, {"smkx", "\033[?1h\033="}, {"rmkx", "\033[?1l\033>"},
+		{"home", "\033[H"}, {"civis", "\033[?25l"}, {"cvvis", "\033[?12;25h"}
+	};
+	const std::vector<std::pair<const char*, const char*>> vt220_capabilities =
+	{
+		{"kpp", "\033[5~"}, {"knp", "\033[6~"}, {"kdch1", "\033[3~"}, {"kich1", "\033[2~"}, {"kf1", "\033OP"}, {"kf2", "\033OQ"},
+		{"kf3", "\033OR"}, {"kf4", "\033OS"}, {"kf6", "\033[17~"}, {"kf7", "\033[18~"}, {"kf8", "\033[19~"}, {"kf9", "\033[20~"},
+		{"kf10", "\033[21~"}, {"kf11", "\033[23~"}, {"kf12", "\033[24~"}, {"kcuu1", "\033[A"}, {"kcud1", "\033[B"}, {"kcub1", "\033[D"},
+		{"kcuf1", "\033[C"}, {"kf13", "\033[25~"}, {"kf14", "\033[26~"}, {"kf17", "\033[31~"}, {"kf18", "\033[32~"}, {"kf19", "\033[33~"},
+		{"kf20", "\033[34~"}, {"home", "\033[H"}, {"civis", "\033[?25l"}
+	};
+	const std::vector<std::pair<const char*, const char*>> linux_capabilities =
+	{
+		{"kpp", "\033[5~"}, {"knp", "\033[6~"}, {"kdch1", "\033[3~"}, {"kich1", "\033[2~"}, {"kend", "\033[4~"}, {"khome", "\033[1~"},
+		{"kf1", "\033[[A"}, {"kf2", "\033[[B"}, {"kf3", "\033[[C"}, {"kf4", "\033[[D"}, {"kf5", "\033[[E"}, {"kf6", "\033[17~"},
+		{"kf7", "\033[18~"}, {"kf8", "\033[19~"}, {"kf9", "\033[20~"}, {"kf10", "\033[21~"}, {"kf11", "\033[23~"}, {"kf12", "\033[24~"},
+		{"kcuu1", "\033[A"}, {"kcud1", "\033[B"}, {"kcub1", "\033[D"}, {"kcuf1", "\033[C"}, {"kf13", "\033[25~"}, {"kf14", "\033[26~"},
+		{"kf15", "\033[28~"}, {"kf16", "\033[29~"}, {"kf17", "\033[31~"}, {"kf18", "\033[32~"}, {"kf19", "\033[33~"}, {"kf20", "\033[34~"},
+		{"home", "\033[H"}, {"civis", "\033[?25l\033[?1c"}, {"cvvis", "\033[?25h\033[?8c"}
+	};
 #endif
 
-	void terminal_info::set()
+	void terminal_info::set(TERMINAL_PROFILE profile)
 	{
 #if defined(__linux__) || defined(__unix__) 
-		std::string infocmp = getCommandOutput("infocmp") + getCommandOutput("infocmp -x");
+		const char* term_env = std::getenv("TERM");
+		const std::string term = term_env ? term_env : "";
 
-		auto getSeq = [&](std::string seq_name)
+		terminfo_entry entry;
+		if (profile != TERMINAL_PROFILE::AUTO || !entry.load(term))
 		{
-			//https://man7.org/linux/man-pages/man5/terminfo.5.html
-			std::vector<int> seq;
-
-			if (infocmp.find(seq_name) != std::string::npos)
+			if (profile == TERMINAL_PROFILE::AUTO)
 			{
-				int s = infocmp.find(seq_name);
-				s += seq_name.size() + 1;
+				profile = term.compare(0, 5, "linux") == 0 ? TERMINAL_PROFILE::LINUX
+					: term.compare(0, 2, "vt") == 0 ? TERMINAL_PROFILE::VT220
+					: TERMINAL_PROFILE::XTERM;
+			}
 
-				while (s < infocmp.size() && infocmp[s] != ',')
-				{
-					if (infocmp[s] == '\\' && s + 1 < infocmp.size())
-					{
-						s++;
-						switch (infocmp[s])
-						{
-						case 'E':
-						case 'e':
-							seq.push_back(27);
-							break;
-						case 'n':
-						case 'l'://?
-							seq.push_back('\n');
-							break;
-						case 'r':
-							seq.push_back('\r');
-							break;
-						case 't':
-							seq.push_back('\t');
-							break;
-						case 'b':
-							seq.push_back('\b');
-							break;
-						case 'f':
-							seq.push_back('\f');
-							break;
-						case 's':
-							seq.push_back(' ');
-							break;
-						case '0':
-							seq.push_back(0);
-							break;
-						default:
-							seq.push_back(infocmp[s]); // eg \^ => ^
-						}
-						s++;
-					}
-					else if (infocmp[s] == '^' && s + 1 < infocmp.size())
-					{
-						s++;
-						if (infocmp[s] == '?')
-						{
-							seq.push_back(127);
-						}
-						else
-						{
-							seq.push_back(infocmp[s] & 0x1F);
-						}
-						s++;
-					}
-					else
-					{
-						seq.push_back(infocmp[s]);
-						s++;
-					}
-				}
+			const auto& capabilities = profile == TERMINAL_PROFILE::LINUX ? linux_capabilities
+				: profile == TERMINAL_PROFILE::VT220 ? vt220_capabilities
+				: xterm_capabilities;
+
+			for (const auto& c : capabilities)
+			{
+				entry.strings[c.first] = c.second;
 			}
+			if (profile != TERMINAL_PROFILE::VT220)
+			{
+				entry.numbers["colors"] = term.find("256color") != std::string::npos ? 256 : 8;
+			}
+		}
 
+		auto getSeq = [&](const std::string& seq_name)
+		{
+			std::vector<int> seq;
+			for (char c : entry.getString(seq_name))
+			{
+				seq.push_back(c);
+			}
 			return seq;
 		};
 
@@ -115,18 +96,6 @@ namespace tui
 		}
 		longest_seq = longest;
 
-		if (longest_seq <= 1)
-		{
-			std::cout << "There were some problems during retrieving information about terminal.\n"
-				"Nonalphanumerical input(arrows F-keys etc) will not work.\n"
-				"Possible reasons: no infocmp present or some problem with it, invalid terminal entry\n"
-				"press 'q' to exit or any other key to continue\n";
-			char k;
-			std::cin >> k;
-
-			if (k == 'q' || k == 'Q') { std::exit(0); }
-		}
-
 		auto vecToStr = [](std::vector<int> vec)
 		{
 			std::string str;
@@ -150,12 +119,16 @@ namespace tui
 		cvvis = t_cvvis.size() > 0 ? t_cvvis : "\033[?25h";
 
 
-		std::string colorterm = getCommandOutput("echo $COLORTERM");
+		color_256 = entry.getNumber("colors") >= 256;
 
-		rgb_color = colorterm.find("truecolor") != std::string::npos || colorterm.find("24bit") != std::string::npos;
+		const char* colorterm = std::getenv("COLORTERM");
+		rgb_color = colorterm && (std::string(colorterm).find("truecolor") != std::string::npos || std::string(colorterm).find("24bit") != std::string::npos);
 
 #endif
 #if defined(_WIN32)
+		rgb_color = false;
+		color_256 = false;
+
 		std::vector<std::pair<int,int>> keys =
 		{
 			{224, 73}, //PGUP
@@ -247,16 +220,67 @@ namespace tui
 			sequences[i].seq = { keys[i].first, keys[i].second };
 		}
 #endif
-	}
 
-	int terminal_info::getSeqNumber(const std::vector<int>& seq)
-	{
+		seq_trie.assign(1, seq_trie_node());
+
 		for (int i = 0; i < sequences.size(); i++)
 		{
-			if (sequences[i].seq == seq)
+			const std::vector<int>& seq = sequences[i].seq;
+
+			if (seq.size() == 0 || std::find(seq.begin(), seq.end(), -1) != seq.end()) { continue; }//unsupported key
+
+			int node = 0;
+			for (int c : seq)
 			{
-				return i;
+				int next = getNextSeqNode(node, c);
+				if (next < 0)
+				{
+					next = seq_trie.size();
+					seq_trie[node].next.push_back({ static_cast<unsigned char>(c), next });
+					seq_trie.push_back(seq_trie_node());
+				}
+				node = next;
 			}
+
+			//first of duplicated sequences is kept
+			if (seq_trie[node].seq_number < 0) { seq_trie[node].seq_number = i; }
+		}
+	}
+
+	terminal_info& getTermInfo()
+	{
+		static terminal_info info = []
+		{
+			terminal_info i;
+			i.set(terminal_profile);
+			return i;
+		}();
+		return info;
+	}
+
+	void setTerminalProfile(TERMINAL_PROFILE profile)
+	{
+		terminal_profile = profile;
+	}
+
+	int terminal_info::getSeqNumber(const std::vector<int>& seq)
+	{
+		if (seq.size() == 0) { return -1; }
+
+		int node = 0;
+		for (int c : seq)
+		{
+			node = getNextSeqNode(node, c);
+			if (node < 0) { return -1; }
+		}
+		return seq_trie[node].seq_number;
+	}
+
+	int terminal_info::getNextSeqNode(int node, unsigned char c) const
+	{
+		for (const auto& n : seq_trie[node].next)
+		{
+			if (n.first == c) { return n.second; }
 		}
 		return -1;
 	}
@@ -1,9 +1,20 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <utility>
+#include <cstdint>
 
 namespace tui 
 {
+	//source of terminal information on *NIX, ignored on Windows
+	enum class TERMINAL_PROFILE : uint8_t
+	{
+		AUTO,//terminfo entry of $TERM, built-in table guessed from $TERM if there is no entry
+		XTERM,//built-in tables, terminfo is not read
+		VT220,
+		LINUX
+	};
+
 	struct key_seq_pair
 	{
 		std::string name;
@@ -13,6 +24,13 @@ namespace tui
 		key_seq_pair(std::string Name, std::vector<int> Seq) : name(Name), seq(Seq) {}
 	};
 
+	//node of prefix tree built from key sequences
+	struct seq_trie_node
+	{
+		int seq_number = -1;//sequence ending at this node, -1 if none
+		std::vector<std::pair<unsigned char, int>> next;//byte and index of following node
+	};
+
 	struct terminal_info
 	{
 		std::vector<key_seq_pair> sequences =
@@ -100,7 +118,10 @@ namespace tui
 			{"kLFT5"}, //CTRL+LEFT
 			{"kRIT5"} //CTRL+RIGHT
 		};
-		unsigned short longest_seq;
+		unsigned short longest_seq = 0;
+
+		//root is at index 0
+		std::vector<seq_trie_node> seq_trie;
 
 		std::string smkx;
 		std::string rmkx;
@@ -108,19 +129,29 @@ namespace tui
 		std::string civis;
 		std::string cvvis;
 
-		bool rgb_color;
-
-		terminal_info() { set(); }
+		bool rgb_color = false;
+		bool color_256 = false;
 
 		//load terminal information
-		void set();
+		void set(TERMINAL_PROFILE profile = TERMINAL_PROFILE::AUTO);
 
 		//return position of sequence, if there is no given sequence return -1
 		int getSeqNumber(const std::vector<int>& seq);
 
+		/*sequences are recognized byte by byte starting from node 0,
+		returns node after given byte, -1 if no sequence starts with such bytes*/
+		int getNextSeqNode(int node, unsigned char c) const;
+		//return position of sequence ending at node, -1 if node is only prefix
+		int getSeqNumberAt(int node) const { return seq_trie[node].seq_number; }
+
 		//return sequence
 		std::vector<int> getSeq(unsigned int seq);
 	};
 
-	extern terminal_info term_info;
+	/*returns terminal information, it is loaded on first call(by init() at latest)
+	using profile given to setTerminalProfile()*/
+	terminal_info& getTermInfo();
+
+	//has to be called before init() to take effect, AUTO by default
+	void setTerminalProfile(TERMINAL_PROFILE profile);
 }
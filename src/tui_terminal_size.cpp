@@ -0,0 +1,118 @@
+#include "tui_terminal_size.h"
+#include "tui_event_loop.h"
+
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+
+#if defined(_WIN32)
+	#include <windows.h>
+#endif
+
+#if defined(__linux__) || defined(__unix__)
+	#include <cerrno>
+	#include <signal.h>
+	#include <sys/ioctl.h>
+	#include <unistd.h>
+#endif
+
+namespace tui
+{
+	//columns << 16 | rows, written also from signal handler
+	std::atomic<uint32_t> terminal_size(0);
+	std::atomic<unsigned int> terminal_resize_count(0);
+
+	std::once_flag terminal_size_init_flag;
+
+	uint32_t readTerminalSize()
+	{
+		uint32_t columns = 0;
+		uint32_t rows = 0;
+
+#if defined(_WIN32)
+		CONSOLE_SCREEN_BUFFER_INFO buffer_info;
+		if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &buffer_info))
+		{
+			columns = buffer_info.srWindow.Right - buffer_info.srWindow.Left + 1;
+			rows = buffer_info.srWindow.Bottom - buffer_info.srWindow.Top + 1;
+		}
+#endif
+
+#if defined(__linux__) || defined(__unix__)
+		winsize w;
+		if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) == 0)
+		{
+			columns = w.ws_col;
+			rows = w.ws_row;
+		}
+#endif
+
+		return (columns & 0xFFFF) << 16 | (rows & 0xFFFF);
+	}
+
+	void updateTerminalSize()
+	{
+		const uint32_t size = readTerminalSize();
+
+		if (terminal_size.exchange(size) != size)
+		{
+			terminal_resize_count++;
+		}
+	}
+
+#if defined(__linux__) || defined(__unix__)
+	struct sigaction prev_sigwinch;
+
+	void sigwinchHandler(int sig)
+	{
+		const int saved_errno = errno;
+
+		updateTerminalSize();
+		event_loop::wakeup();
+
+		errno = saved_errno;
+
+		if (!(prev_sigwinch.sa_flags & SA_SIGINFO)
+			&& prev_sigwinch.sa_handler != SIG_DFL
+			&& prev_sigwinch.sa_handler != SIG_IGN)
+		{
+			prev_sigwinch.sa_handler(sig);
+		}
+	}
+#endif
+
+	void initTerminalSize()
+	{
+		std::call_once(terminal_size_init_flag, []
+		{
+			updateTerminalSize();
+
+#if defined(__linux__) || defined(__unix__)
+			struct sigaction sa = {};
+			sa.sa_handler = sigwinchHandler;
+			sigemptyset(&sa.sa_mask);
+			sa.sa_flags = SA_RESTART;
+			sigaction(SIGWINCH, &sa, &prev_sigwinch);
+#endif
+		});
+	}
+
+	vec2i getTerminalSize()
+	{
+		initTerminalSize();
+
+#if defined(_WIN32)
+		updateTerminalSize();
+#endif
+
+		const uint32_t size = terminal_size.load();
+		return { static_cast<int>(size >> 16), static_cast<int>(size & 0xFFFF) };
+	}
+
+	unsigned int getTerminalResizeCount()
+	{
+		initTerminalSize();
+
+		return terminal_resize_count.load();
+	}
+}
\ No newline at end of file
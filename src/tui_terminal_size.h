@@ -0,0 +1,17 @@
+//this file contains functions returning terminal size without querying terminal every frame
+#pragma once
+#include "tui_vec2.h"
+
+namespace tui
+{
+	/*reads terminal size and installs SIGWINCH handler which updates it,
+	called by output::init(), other functions call it when needed*/
+	void initTerminalSize();
+
+	/*returns cached terminal size(columns, rows), does not perform any syscall on POSIX,
+	on windows there is no resize notification and size is read on every call*/
+	vec2i getTerminalSize();
+
+	//incremented on every change of terminal size
+	unsigned int getTerminalResizeCount();
+}
\ No newline at end of file
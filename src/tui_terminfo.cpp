@@ -0,0 +1,252 @@
+#include "tui_terminfo.h"
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <utility>
+
+#if defined(__linux__) || defined(__unix__)
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace tui
+{
+	//https://man7.org/linux/man-pages/man5/term.5.html
+	constexpr int TERMINFO_MAGIC = 0432;//numbers are 16bit
+	constexpr int TERMINFO_MAGIC_32 = 01036;//numbers are 32bit
+
+	//positions of standard capabilities used by tui, order is fixed by term.h
+	const std::vector<std::pair<const char*, int>> standard_strings =
+	{
+		{"home", 12}, {"civis", 13}, {"cvvis", 20},
+		{"kdch1", 59}, {"kcud1", 61}, {"kf1", 66}, {"kf10", 67},
+		{"kf2", 68}, {"kf3", 69}, {"kf4", 70}, {"kf5", 71}, {"kf6", 72}, {"kf7", 73}, {"kf8", 74}, {"kf9", 75},
+		{"khome", 76}, {"kich1", 77}, {"kcub1", 79}, {"knp", 81}, {"kpp", 82}, {"kcuf1", 83}, {"kcuu1", 87},
+		{"rmkx", 88}, {"smkx", 89}, {"kend", 164}, {"kLFT", 201}, {"kRIT", 210}
+		//kf11 - kf63 are at 216 - 268
+	};
+	const std::vector<std::pair<const char*, int>> standard_numbers =
+	{
+		{"colors", 13}
+	};
+
+	int readLe16(const unsigned char* p) { return static_cast<int16_t>(p[0] | p[1] << 8); }
+	int readLe32(const unsigned char* p) { return static_cast<int32_t>(p[0] | p[1] << 8 | p[2] << 16 | static_cast<uint32_t>(p[3]) << 24); }
+
+	//reads null-terminated string at offset of table, returns false if offset is invalid
+	bool readTableString(const unsigned char* table, size_t table_size, int offset, std::string& str)
+	{
+		if (offset < 0 || static_cast<size_t>(offset) >= table_size) { return false; }
+
+		size_t end = offset;
+		while (end < table_size && table[end] != 0) { end++; }
+		if (end == table_size) { return false; }
+
+		str.assign(reinterpret_cast<const char*>(table + offset), end - offset);
+		return true;
+	}
+
+	bool terminfo_entry::parse(const unsigned char* data, size_t size)
+	{
+		strings.clear();
+		numbers.clear();
+		booleans.clear();
+
+		if (size < 12) { return false; }
+
+		const int magic = readLe16(data);
+		if (magic != TERMINFO_MAGIC && magic != TERMINFO_MAGIC_32) { return false; }
+		const size_t num_size = magic == TERMINFO_MAGIC ? 2 : 4;
+
+		const int names_size = readLe16(data + 2);
+		const int bool_count = readLe16(data + 4);
+		const int num_count = readLe16(data + 6);
+		const int str_count = readLe16(data + 8);
+		const int table_size = readLe16(data + 10);
+		if (names_size < 0 || bool_count < 0 || num_count < 0 || str_count < 0 || table_size < 0) { return false; }
+
+		auto readNumber = [&](const unsigned char* p) { return num_size == 2 ? readLe16(p) : readLe32(p); };
+
+		//sections follow each other, numbers start at even offset
+		size_t pos = 12 + names_size + bool_count;
+		pos += pos % 2;
+		const unsigned char* nums = data + pos;
+		pos += num_count * num_size;
+		const unsigned char* str_offsets = data + pos;
+		pos += str_count * 2;
+		const unsigned char* table = data + pos;
+		pos += table_size;
+
+		if (pos > size) { return false; }
+
+		for (const auto& s : standard_numbers)
+		{
+			if (s.second >= num_count) { continue; }
+
+			int n = readNumber(nums + s.second * num_size);
+			if (n >= 0) { numbers[s.first] = n; }
+		}
+
+		std::string str;
+		auto readStandardString = [&](const std::string& name, int idx)
+		{
+			if (idx < str_count && readTableString(table, table_size, readLe16(str_offsets + idx * 2), str))
+			{
+				strings[name] = str;
+			}
+		};
+		for (const auto& s : standard_strings)
+		{
+			readStandardString(s.first, s.second);
+		}
+		for (int i = 11; i <= 63; i++)
+		{
+			readStandardString("kf" + std::to_string(i), 216 + i - 11);
+		}
+
+		//extended capabilities(ncurses), optional
+		pos += pos % 2;
+		if (pos + 10 > size) { return true; }
+
+		const int ext_bool_count = readLe16(data + pos);
+		const int ext_num_count = readLe16(data + pos + 2);
+		const int ext_str_count = readLe16(data + pos + 4);
+		const int ext_table_size = readLe16(data + pos + 8);
+		if (ext_bool_count < 0 || ext_num_count < 0 || ext_str_count < 0 || ext_table_size < 0) { return true; }
+		pos += 10;
+
+		const unsigned char* ext_bools = data + pos;
+		pos += ext_bool_count;
+		pos += pos % 2;
+		const unsigned char* ext_nums = data + pos;
+		pos += ext_num_count * num_size;
+		const unsigned char* ext_str_offsets = data + pos;
+		pos += ext_str_count * 2;
+		const unsigned char* name_offsets = data + pos;
+		pos += (ext_bool_count + ext_num_count + ext_str_count) * 2;
+		const unsigned char* ext_table = data + pos;
+		pos += ext_table_size;
+
+		if (pos > size) { return true; }
+
+		//string values are followed by names, name offsets are relative to first name
+		std::vector<std::string> values(ext_str_count);
+		std::vector<bool> has_value(ext_str_count, false);
+		size_t names_begin = 0;
+		for (int i = 0; i < ext_str_count; i++)
+		{
+			int offset = readLe16(ext_str_offsets + i * 2);
+			if (readTableString(ext_table, ext_table_size, offset, values[i]))
+			{
+				has_value[i] = true;
+				names_begin = std::max(names_begin, offset + values[i].size() + 1);
+			}
+		}
+
+		std::string name;
+		for (int i = 0; i < ext_bool_count + ext_num_count + ext_str_count; i++)
+		{
+			if (!readTableString(ext_table + names_begin, ext_table_size - names_begin, readLe16(name_offsets + i * 2), name)) { continue; }
+
+			if (i < ext_bool_count)
+			{
+				if (ext_bools[i] == 1) { booleans[name] = true; }
+			}
+			else if (i < ext_bool_count + ext_num_count)
+			{
+				int n = readNumber(ext_nums + (i - ext_bool_count) * num_size);
+				if (n >= 0) { numbers[name] = n; }
+			}
+			else if (has_value[i - ext_bool_count - ext_num_count])
+			{
+				strings[name] = values[i - ext_bool_count - ext_num_count];
+			}
+		}
+
+		return true;
+	}
+
+	bool terminfo_entry::load(const std::string& term_name)
+	{
+#if defined(__linux__) || defined(__unix__)
+		if (term_name.size() == 0 || term_name.find('/') != std::string::npos) { return false; }
+
+		std::vector<std::string> dirs;
+
+		if (const char* terminfo = std::getenv("TERMINFO")) { dirs.push_back(terminfo); }
+		if (const char* home = std::getenv("HOME")) { dirs.push_back(std::string(home) + "/.terminfo"); }
+		if (const char* terminfo_dirs = std::getenv("TERMINFO_DIRS"))
+		{
+			std::string list = terminfo_dirs;
+			size_t begin = 0;
+			for (;;)
+			{
+				size_t end = list.find(':', begin);
+				std::string dir = list.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+				dirs.push_back(dir.size() > 0 ? dir : "/usr/share/terminfo");//empty - default location
+
+				if (end == std::string::npos) { break; }
+				begin = end + 1;
+			}
+		}
+		for (const char* dir : { "/etc/terminfo", "/lib/terminfo", "/usr/share/terminfo", "/usr/lib/terminfo" })
+		{
+			dirs.push_back(dir);
+		}
+
+		//entries are in subdirectories named by first character or its hex code(on macOS)
+		char hex[3];
+		std::snprintf(hex, sizeof(hex), "%02x", static_cast<unsigned char>(term_name[0]));
+
+		for (const auto& dir : dirs)
+		{
+			for (const std::string& sub : { std::string(1, term_name[0]), std::string(hex) })
+			{
+				std::string path = dir + '/' + sub + '/' + term_name;
+
+				int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+				if (fd < 0) { continue; }
+
+				bool loaded = false;
+				struct stat st;
+				if (fstat(fd, &st) == 0 && st.st_size > 0)
+				{
+					void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+					if (data != MAP_FAILED)
+					{
+						loaded = parse(static_cast<const unsigned char*>(data), st.st_size);
+						munmap(data, st.st_size);
+					}
+				}
+				close(fd);
+
+				if (loaded) { return true; }
+			}
+		}
+#endif
+		return false;
+	}
+
+	std::string terminfo_entry::getString(const std::string& name) const
+	{
+		auto it = strings.find(name);
+		return it != strings.end() ? it->second : std::string();
+	}
+
+	int terminfo_entry::getNumber(const std::string& name) const
+	{
+		auto it = numbers.find(name);
+		return it != numbers.end() ? it->second : -1;
+	}
+
+	bool terminfo_entry::getBoolean(const std::string& name) const
+	{
+		auto it = booleans.find(name);
+		return it != booleans.end() && it->second;
+	}
+}
\ No newline at end of file
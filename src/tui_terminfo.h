@@ -0,0 +1,28 @@
+//this file contains terminfo_entry, reader of compiled terminfo database entries(term(5) format)
+#pragma once
+#include <string>
+#include <unordered_map>
+
+namespace tui
+{
+	struct terminfo_entry
+	{
+		//only capabilities used by tui are read from standard part, all from extended part(names as in infocmp -x)
+		std::unordered_map<std::string, std::string> strings;
+		std::unordered_map<std::string, int> numbers;
+		std::unordered_map<std::string, bool> booleans;
+
+		/*finds entry of given terminal in $TERMINFO, ~/.terminfo, $TERMINFO_DIRS and system directories,
+		maps and parses it, returns false if entry was not found or is invalid*/
+		bool load(const std::string& term_name);
+
+		//parses contents of compiled entry, returns false if it is invalid
+		bool parse(const unsigned char* data, size_t size);
+
+		//returns empty string if there is no such capability
+		std::string getString(const std::string& name) const;
+		//returns -1 if there is no such capability
+		int getNumber(const std::string& name) const;
+		bool getBoolean(const std::string& name) const;
+	};
+}
\ No newline at end of file
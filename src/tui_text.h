@@ -9,8 +9,11 @@ struct text - widget that displays text*/
 #include "tui_active_element.h"
 #include "tui_input.h"
 #include "tui_scroll.h"
+#include "tui_symbol_rope.h"
 
 #include <algorithm>
+#include <vector>
+#include <iterator>
 
 namespace tui
 {
@@ -62,8 +65,17 @@ namespace tui
 		surface m_text;
 		scroll<DIRECTION::VERTICAL> m_scroll;
 
-		symbol_string m_unprepared_text;
-		std::vector<vec2i> m_symbol_pos;
+		symbol_rope m_unprepared_text;
+
+		//layout of text up to and including newline
+		struct paragraph_layout
+		{
+			size_t begin = 0;//index of first symbol
+			unsigned int line = 0;//first line
+			unsigned int lines = 0;//lines occupied, next paragraph begins at line + lines
+			std::vector<vec2i> positions;//y relative to first line
+		};
+		std::vector<paragraph_layout> m_paragraphs;//always at least one, last one does not end with newline
 
 		bool m_use_control_characters = true;
 		bool m_use_word_breaking = true;
@@ -74,7 +86,26 @@ namespace tui
 		friend struct input_text;
 		vec2i getSymbolPos(unsigned int i) const
 		{
-			return m_symbol_pos[i];
+			const paragraph_layout& par = m_paragraphs[findParagraph(i)];
+			vec2i pos = par.positions[i - par.begin];
+			pos.y += par.line;
+			return pos;
+		}
+
+		//returns index of paragraph containing symbol i
+		size_t findParagraph(size_t i) const
+		{
+			auto it = std::upper_bound(m_paragraphs.begin(), m_paragraphs.end(), i, [](size_t idx, const paragraph_layout& par)
+			{
+				return idx < par.begin;
+			});
+			return it - m_paragraphs.begin() - 1;
+		}
+
+		//paragraphs are separated only when newline moves to next line
+		bool isParagraphEnd(const symbol& sym) const
+		{
+			return m_use_control_characters && sym[0] == '\n' && sym.getWidth() == 0;
 		}
 
 		void fill()
@@ -82,28 +113,28 @@ namespace tui
 			clear();
 			m_text.makeTransparent();
 
-			if (m_symbol_pos.size() > 0)
+			const int top = m_scroll.getTopPosition();
+
+			auto f_par = std::upper_bound(m_paragraphs.begin(), m_paragraphs.end(), top, [](int line, const paragraph_layout& par)
 			{
-				auto f_it = std::lower_bound(
-					m_symbol_pos.begin(),
-					m_symbol_pos.end(),
-					vec2i(0, m_scroll.getTopPosition()),
-					[&](const vec2i& a, const vec2i& b) 
-					{
-						return a.y * m_text.getSize().x + a.x < b.y * m_text.getSize().x + b.x;
-					}
-				);	
+				return line < static_cast<int>(par.line);
+			});
+			if (f_par != m_paragraphs.begin()) { --f_par; }
 
-				for (int i = f_it - m_symbol_pos.begin(); i < m_unprepared_text.size(); i++)
+			for (auto par = f_par; par != m_paragraphs.end() && static_cast<int>(par->line) - top < m_text.getSize().y; ++par)
+			{
+				for (size_t i = 0; i < par->positions.size(); i++)
 				{
-					vec2i p = m_symbol_pos[i];
-					p.y -= m_scroll.getTopPosition();
+					vec2i p = par->positions[i];
+					p.y += static_cast<int>(par->line) - top;
 
+					if (p.y < 0) { continue; }
 					if (p.y >= m_text.getSize().y) { break; }
 
-					if (m_unprepared_text[i].getWidth() > 0)
+					const symbol& sym = m_unprepared_text[par->begin + i];
+					if (sym.getWidth() > 0)
 					{
-						m_text.setSymbolAt(m_unprepared_text[i], p);
+						m_text.setSymbolAt(sym, p);
 					}
 				}
 			}
@@ -111,23 +142,28 @@ namespace tui
 			insertSurface(m_text);
 			if (m_display_scroll && m_scroll.isNeeded()) { insertSurface(m_scroll, false); }
 		}
-		void prepareText()
+
+		/*lays out symbols from begin to the end of paragraph for given width,
+		stops after placing first symbol at line max_line or further*/
+		void layoutParagraph(size_t begin, int width, paragraph_layout& par, unsigned int max_line = -1) const
 		{
-			m_symbol_pos.resize(m_unprepared_text.size());
+			par.begin = begin;
+			par.positions.clear();
 
 			int pos = 0;
-			for (int i = 0; i < m_unprepared_text.size(); i++)
+			for (size_t i = begin; i < m_unprepared_text.size(); i++)
 			{
-				const uint8_t sym_w = m_unprepared_text[i].getWidth();
+				const symbol& sym = m_unprepared_text[i];
+				const uint8_t sym_w = sym.getWidth();
 
 				auto posInLine = [&]()
 				{
-					return pos % m_text.getSize().x;
+					return pos % width;
 				};
 
-				if (posInLine() + sym_w > m_text.getSize().x && posInLine() != 0)
+				if (posInLine() + sym_w > width && posInLine() != 0)
 				{
-					pos += m_text.getSize().x - posInLine();
+					pos += width - posInLine();
 				}	
 
 				auto isWB = [](const symbol& sym)//word boundary
@@ -140,11 +176,11 @@ namespace tui
 					if (i != 0 && isWB(m_unprepared_text[i - 1]))
 					{
 						unsigned int word_len = 0;
-						const unsigned int dst = m_text.getSize().x - posInLine();
+						const unsigned int dst = width - posInLine();
 
-						for (int j = 0; j + i < m_unprepared_text.size() && !isWB(m_unprepared_text[j + i]) && word_len <= getSize().x; j++)
+						for (size_t j = i; j < m_unprepared_text.size() && !isWB(m_unprepared_text[j]) && word_len <= getSize().x; j++)
 						{
-							word_len += m_unprepared_text[j + i].getWidth();
+							word_len += m_unprepared_text[j].getWidth();
 						}
 						if (word_len > dst && word_len < getSize().x) 
 						{
@@ -153,12 +189,16 @@ namespace tui
 					}
 				}
 
-				m_symbol_pos[i] = { posInLine(), pos / m_text.getSize().x };
+				par.positions.push_back({ posInLine(), pos / width });
+				const vec2i& p = par.positions.back();
 
-				if (posInLine() == 0 && m_unprepared_text[i][0] == ' ' 
+				if (static_cast<unsigned int>(p.y) >= max_line) { break; }
+
+				//symbol before paragraph is always in previous line
+				if (posInLine() == 0 && sym[0] == ' ' 
 					&& 
 					(
-						(i>0 && m_symbol_pos[i].y == m_symbol_pos[i-1].y) ? m_unprepared_text[i-1][0] != ' ' : true
+						(i > begin && p.y == par.positions[par.positions.size() - 2].y) ? m_unprepared_text[i - 1][0] != ' ' : true
 					)
 				)
 				{
@@ -169,39 +209,133 @@ namespace tui
 				{
 					if (m_use_control_characters)
 					{
-						switch (m_unprepared_text[i][0])
+						switch (sym[0])
 						{
 						case '\n':
-							pos += m_text.getSize().x - posInLine();
+							pos += width - posInLine();
 							break;
 						case '\t':
 							pos += 4;
 						}
 					}
+					if (isParagraphEnd(sym)) { break; }
 					continue;
 				}
 
 				pos += sym_w;
 			}
+
+			par.lines = par.positions.size() > 0 ? pos / width : 0;
+		}
+
+		//returns true if text laid out for given width would occupy more than given number of lines
+		bool exceedsLines(int width, unsigned int lines) const
+		{
+			paragraph_layout par;
+			size_t begin = 0;
+			unsigned int line = 0;
+
+			while (begin < m_unprepared_text.size())
+			{
+				layoutParagraph(begin, width, par, lines - line);
+				if (par.positions.size() > 0 && par.positions.back().y + line >= lines) { return true; }
+
+				begin += par.positions.size();
+				line += par.lines;
+			}
+			return false;
 		}
 
-		void adjustSizes()
+		//lays out paragraphs from first_begin, stops at the end of text or at first paragraph ending at symbol for which stop returns true
+		template<typename F>
+		std::vector<paragraph_layout> layoutParagraphs(size_t first_begin, F stop) const
 		{
-			m_text.setSizeInfo({ {0,0}, {100,100} });
-			updateSurfaceSize(m_text);
-			prepareText();
+			std::vector<paragraph_layout> paragraphs;
+
+			size_t begin = first_begin;
+			for (;;)
+			{
+				paragraphs.emplace_back();
+				layoutParagraph(begin, m_text.getSize().x, paragraphs.back());
+
+				const size_t size = paragraphs.back().positions.size();
+				begin += size;
+				if (size == 0 || !isParagraphEnd(m_unprepared_text[begin - 1]) || stop(begin)) { break; }
+			}
+			return paragraphs;
+		}
+
+		//updates first lines of paragraphs starting from first
+		void updateLines(size_t first)
+		{
+			for (size_t p = std::max<size_t>(first, 1); p < m_paragraphs.size(); p++)
+			{
+				m_paragraphs[p].line = m_paragraphs[p - 1].line + m_paragraphs[p - 1].lines;
+			}
+		}
+
+		void prepareText()
+		{
+			m_paragraphs = layoutParagraphs(0, [](size_t) { return false; });
+			m_paragraphs.front().line = 0;
+			updateLines(1);
+		}
+
+		//re-lays out only paragraphs affected by replacing erased symbols at idx with inserted symbols
+		void reflow(size_t idx, size_t erased, size_t inserted)
+		{
+			const size_t first = findParagraph(idx);
+			size_t last = m_paragraphs.size();//one past last replaced paragraph
+
+			//paragraphs following edited part keep their layout, stop when boundary matches old one
+			std::vector<paragraph_layout> laid_out = layoutParagraphs(m_paragraphs[first].begin, [&](size_t end)
+			{
+				if (end < idx + inserted) { return false; }
+
+				const size_t old_end = end - inserted + erased;
+				const size_t p = findParagraph(old_end);
+				if (m_paragraphs[p].begin != old_end) { return false; }
+
+				last = p;
+				return true;
+			});
+
+			for (size_t p = last; p < m_paragraphs.size(); p++)
+			{
+				m_paragraphs[p].begin = m_paragraphs[p].begin + inserted - erased;
+			}
+			m_paragraphs.erase(m_paragraphs.begin() + first, m_paragraphs.begin() + last);
+			m_paragraphs.insert(m_paragraphs.begin() + first, std::make_move_iterator(laid_out.begin()), std::make_move_iterator(laid_out.end()));
+			
+			m_paragraphs.front().line = 0;
+			updateLines(first);
+
+			//scroll appears or disappears
 			if (m_display_scroll)
 			{
-				if (getNumberOfLines() > m_text.getSize().y)
+				const bool narrowed = m_text.getSize().x < getSize().x;
+				if (narrowed != exceedsLines(getSize().x, m_text.getSize().y))
 				{
-					m_text.setSizeInfo({ {-1,0}, {100,100} });
-					updateSurfaceSize(m_text);
-					prepareText();
+					adjustSizes();
+					return;
 				}
 			}
 			m_scroll.setContentLength(getNumberOfLines());
 		}
 
+		void adjustSizes()
+		{
+			m_text.setSizeInfo({ {0,0}, {100,100} });
+			updateSurfaceSize(m_text);
+			if (m_display_scroll && exceedsLines(m_text.getSize().x, m_text.getSize().y))
+			{
+				m_text.setSizeInfo({ {-1,0}, {100,100} });
+				updateSurfaceSize(m_text);
+			}
+			prepareText();
+			m_scroll.setContentLength(getNumberOfLines());
+		}
+
 		void resizeAction() override
 		{
 			updateSurfaceSize(m_scroll);
@@ -249,19 +383,35 @@ namespace tui
 			setAppearanceAction();
 		}
 
-		void setText(const symbol_string& txt)
+		void setText(const symbol_string& txt) { setText(symbol_rope(txt)); }
+		//rope is shared, not copied
+		void setText(const symbol_rope& txt)
 		{
 			m_unprepared_text = txt;
 			adjustSizes();
 			m_redraw_needed = true;
 		}
-		symbol_string getText() const { return m_unprepared_text; }
+		symbol_string getText() const { return m_unprepared_text.getSymbolString(); }
+
+		//following functions re-lay out only edited paragraphs
+		void replaceText(unsigned int idx, unsigned int count, const symbol_string& txt)
+		{
+			idx = std::min(idx, (unsigned int)m_unprepared_text.size());
+			count = std::min(count, (unsigned int)m_unprepared_text.size() - idx);
+
+			m_unprepared_text.erase(idx, count);
+			m_unprepared_text.insert(idx, txt);
+			reflow(idx, count, txt.size());
+			m_redraw_needed = true;
+		}
+		void insertText(unsigned int idx, const symbol_string& txt) { replaceText(idx, 0, txt); }
+		void eraseText(unsigned int idx, unsigned int count = 1) { replaceText(idx, count, symbol_string()); }
 
 		unsigned int getNumberOfLines() const
 		{
-			if (m_symbol_pos.size() > 0)
+			if (m_unprepared_text.size() > 0)
 			{
-				return m_symbol_pos.back().y + 1;
+				return getSymbolPos(m_unprepared_text.size() - 1).y + 1;
 			}
 			return 0;
 		}
@@ -343,7 +493,7 @@ namespace tui
 				setSizeInfo({ {(int)max_width, 1} });
 				prepareText();
 
-				int h = m_symbol_pos.back().y;
+				int h = getNumberOfLines() - 1;
 
 				m_scroll.setContentLength(h);
 				setSizeInfo({ {(int)max_width, h} });
@@ -1,100 +1,267 @@
 #include "tui_unicode_utils.h"
 
-#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#if !defined(TUI_DISABLE_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+	#define TUI_UTF8_SSE2
+	#include <emmintrin.h>
+#endif
+#if !defined(TUI_DISABLE_SIMD) && defined(__AVX2__)
+	#define TUI_UTF8_AVX2
+	#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
 
 namespace tui
 {
+	#include "udata/properties.h"
+
+	constexpr uint8_t GRAPHEME_TYPE_MASK = 0x0F;
+	constexpr uint8_t WIDE_BIT = 0x10;
+	constexpr uint8_t PICTOGRAPHIC_BIT = 0x20;
+
+	//two-stage lookup, no searching and no static initialization
+	inline uint8_t getProperties(char32_t cp)
+	{
+		if (cp > 0x10FFFF) { return 0; }
+		return properties_stage2[properties_stage1[cp >> 8]][cp & 0xFF];
+	}
+
 	GRAPHEME_TYPE getGraphemeType(char32_t grapheme)
 	{
-		struct grapheme_range_info { unsigned int r_s, r_e; GRAPHEME_TYPE r_t; };
+		if (grapheme >= 32 && grapheme <= 126) { return GRAPHEME_TYPE::OTHER; }
 
-		static const std::vector<grapheme_range_info> ranges =
-		{
-			#include "udata/grapheme_ranges.h"
-		};
+		return static_cast<GRAPHEME_TYPE>(getProperties(grapheme) & GRAPHEME_TYPE_MASK);
+	}
 
-		unsigned int s = 0;
-		unsigned int e = ranges.size() - 1;
+	//number of lowest zero bits, x != 0
+	inline int countTrailingZeros(uint32_t x)
+	{
+#if defined(_MSC_VER)
+		unsigned long i;
+		_BitScanForward(&i, x);
+		return i;
+#else
+		return __builtin_ctz(x);
+#endif
+	}
 
-		while (s <= e)
+	/*converts leading ascii bytes of src to dst, returns their number,
+	dst has to have room for n code points*/
+	inline size_t decodeAsciiRun(const unsigned char* src, size_t n, char32_t* dst)
+	{
+		size_t i = 0;
+#ifdef TUI_UTF8_AVX2
+		for (; i + 32 <= n; i += 32)
 		{
-			unsigned int c = (s + e) / 2;
-
-			if (ranges[c].r_s > grapheme)
+			const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+			const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(v));
+			if (mask != 0)
 			{
-				e = --c;
+				const size_t end = i + countTrailingZeros(mask);
+				for (; i < end; i++) { dst[i] = src[i]; }
+				return i;
 			}
-			else if (ranges[c].r_e < grapheme)
+
+			for (int k = 0; k < 32; k += 8)
 			{
-				s = ++c;
+				const __m128i b = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i + k));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + k), _mm256_cvtepu8_epi32(b));
 			}
-			else
+		}
+#endif
+#ifdef TUI_UTF8_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		for (; i + 16 <= n; i += 16)
+		{
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(v));
+			if (mask != 0)
 			{
-				return ranges[c].r_t;
+				const size_t end = i + countTrailingZeros(mask);
+				for (; i < end; i++) { dst[i] = src[i]; }
+				return i;
 			}
+
+			const __m128i lo = _mm_unpacklo_epi8(v, zero);
+			const __m128i hi = _mm_unpackhi_epi8(v, zero);
+			__m128i* out = reinterpret_cast<__m128i*>(dst + i);
+			_mm_storeu_si128(out, _mm_unpacklo_epi16(lo, zero));
+			_mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo, zero));
+			_mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi, zero));
+			_mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi, zero));
 		}
-		return GRAPHEME_TYPE::OTHER;
+#endif
+		for (; i < n && src[i] < 0x80; i++) { dst[i] = src[i]; }
+		return i;
 	}
 
-	std::u32string utf8ToUtf32(const char* utf8_str, size_t len, bool shrink_after, float reserve_ratio)
+	inline bool isContinuation(unsigned char c) { return (c & 0b11000000) == 0b10000000; }
+
+	/*decodes single sequence starting with non-ascii byte, returns its length,
+	invalid sequence(maximal subpart of it) is returned as negative length and cp is set to U+FFFD*/
+	inline int decodeSequence(const unsigned char* src, size_t n, char32_t& cp)
 	{
-		std::u32string utf32_str;
-		utf32_str.reserve(len * reserve_ratio);
+		const unsigned char c = src[0];
 
-		char32_t utf32_char = 0;
-		int bitc = 0;
+		int length;
+		unsigned char min = 0x80, max = 0xBF;//allowed range of second byte
+		if (c >= 0xC2 && c <= 0xDF) { length = 2; cp = c & 0b00011111; }
+		else if (c >= 0xE0 && c <= 0xEF)
+		{
+			length = 3;
+			cp = c & 0b00001111;
+			if (c == 0xE0) { min = 0xA0; }//overlong
+			if (c == 0xED) { max = 0x9F; }//surrogates
+		}
+		else if (c >= 0xF0 && c <= 0xF4)
+		{
+			length = 4;
+			cp = c & 0b00000111;
+			if (c == 0xF0) { min = 0x90; }//overlong
+			if (c == 0xF4) { max = 0x8F; }//above U+10FFFF
+		}
+		else
+		{
+			cp = U'\xFFFD';
+			return -1;
+		}
 
-		auto push = [&](int i)
+		for (int i = 1; i < length; i++)
 		{
-			if (i > 0)
+			if (static_cast<size_t>(i) >= n || !isContinuation(src[i]) || (i == 1 && (src[1] < min || src[1] > max)))
 			{
-				if (bitc == 0 && !(utf32_char >= 0xD800 && utf32_char <= 0xDFFF) && utf32_char <= 0x10FFFF)
-				{
-					utf32_str.push_back(utf32_char);
-				}
-				else { utf32_str.push_back(U'\xFFFD'); }
+				cp = U'\xFFFD';
+				return -i;
 			}
-		};
+			cp = cp << 6 | (src[i] & 0b00111111);
+		}
+		return length;
+	}
+
+	size_t decodeUtf8(const char* utf8_str, size_t len, char32_t* dst)
+	{
+		const unsigned char* src = reinterpret_cast<const unsigned char*>(utf8_str);
+		size_t i = 0;
+		char32_t* out = dst;
+
+		while (i < len)
+		{
+			const size_t ascii = decodeAsciiRun(src + i, len - i, out);
+			i += ascii;
+			out += ascii;
+
+			if (i == len) { break; }
+
+			const int length = decodeSequence(src + i, len - i, *out++);
+			i += length > 0 ? length : -length;
+		}
+
+		return out - dst;
+	}
+
+	char32_t decodeUtf8CodePoint(const char* utf8_str, size_t len, size_t& length)
+	{
+		length = len > 0 ? 1 : 0;
+		if (len == 0) { return 0; }
+
+		const unsigned char* src = reinterpret_cast<const unsigned char*>(utf8_str);
+		if (src[0] < 0x80) { return src[0]; }
 
-		for (int i = 0; i < len; i++)
+		char32_t cp;
+		const int l = decodeSequence(src, len, cp);
+		length = l > 0 ? l : -l;
+		return cp;
+	}
+
+	bool isValidUtf8(const char* utf8_str, size_t len)
+	{
+		const unsigned char* src = reinterpret_cast<const unsigned char*>(utf8_str);
+		size_t i = 0;
+
+		while (i < len)
 		{
-			if ((utf8_str[i] & 0b10000000) == 0b00000000)
+#if defined(TUI_UTF8_SSE2)
+			for (; i + 16 <= len; i += 16)
 			{
-				push(i);
-				bitc = 0;
-				utf32_char = utf8_str[i];
+				if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))) != 0) { break; }
 			}
-			else if ((utf8_str[i] & 0b11000000) == 0b10000000)
+#endif
+			for (; i < len && src[i] < 0x80; i++) {}
+
+			if (i == len) { break; }
+
+			char32_t cp;
+			const int length = decodeSequence(src + i, len - i, cp);
+			if (length < 0) { return false; }
+			i += length;
+		}
+		return true;
+	}
+
+	size_t encodeUtf8(const char32_t* utf32_str, size_t len, char* dst)
+	{
+		size_t i = 0;
+		char* out = dst;
+
+		while (i < len)
+		{
+#ifdef TUI_UTF8_SSE2
+			//blocks of 8 ascii code points are narrowed to bytes
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i non_ascii = _mm_set1_epi32(~0x7F);
+			for (; i + 8 <= len; i += 8)
 			{
-				bitc -= 6;
-				utf32_char |= (utf8_str[i] & 0b00111111) << bitc;
+				const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf32_str + i));
+				const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf32_str + i + 4));
+				const __m128i high = _mm_and_si128(_mm_or_si128(a, b), non_ascii);
+				if (_mm_movemask_epi8(_mm_cmpeq_epi32(high, zero)) != 0xFFFF) { break; }
+
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(_mm_packs_epi32(a, b), zero));
+				out += 8;
 			}
-			else if ((utf8_str[i] & 0b11100000) == 0b11000000)
+#endif
+			for (; i < len && utf32_str[i] < 0x80; i++) { *out++ = static_cast<char>(utf32_str[i]); }
+
+			if (i == len) { break; }
+
+			const char32_t cp = utf32_str[i++];
+			if ((cp >= 0xD800 && cp <= 0xDFFF) || cp > 0x10FFFF)
 			{
-				push(i);
-				bitc = 6;
-				utf32_char = (utf8_str[i] & 0b000111111) << bitc;
+				*out++ = '\xEF';
+				*out++ = '\xBF';
+				*out++ = '\xBD';
 			}
-			else if ((utf8_str[i] & 0b11110000) == 0b11100000)
+			else if (cp < (1 << 11))
 			{
-				push(i);
-				bitc = 12;
-				utf32_char = (utf8_str[i] & 0b00001111) << bitc;
+				*out++ = (cp >> 6) | 0b11000000;
+				*out++ = (cp & 0b00111111) | 0b10000000;
 			}
-			else if ((utf8_str[i] & 0b11111000) == 0b11110000)
+			else if (cp < (1 << 16))
 			{
-				push(i);
-				bitc = 18;
-				utf32_char = (utf8_str[i] & 0b00000111) << bitc;
+				*out++ = (cp >> 12) | 0b11100000;
+				*out++ = ((cp >> 6) & 0b00111111) | 0b10000000;
+				*out++ = (cp & 0b00111111) | 0b10000000;
 			}
 			else
 			{
-				push(i);
-				bitc = -1;
+				*out++ = (cp >> 18) | 0b11110000;
+				*out++ = ((cp >> 12) & 0b00111111) | 0b10000000;
+				*out++ = ((cp >> 6) & 0b00111111) | 0b10000000;
+				*out++ = (cp & 0b00111111) | 0b10000000;
 			}
 		}
 
-		if (len > 0) { push(true); }
+		return out - dst;
+	}
+
+	std::u32string utf8ToUtf32(const char* utf8_str, size_t len, bool shrink_after, float)
+	{
+		std::u32string utf32_str(len, U'\0');
+		utf32_str.resize(decodeUtf8(utf8_str, len, &utf32_str[0]));
 
 		if (shrink_after)
 		{
@@ -108,56 +275,10 @@ namespace tui
 		return utf8ToUtf32(utf8_str.data(), utf8_str.size(), shrink_after, reserve_ratio);
 	}
 
-	std::string utf32ToUtf8(const char32_t* utf32_str, size_t len, bool shrink_after, float reserve_ratio)
+	std::string utf32ToUtf8(const char32_t* utf32_str, size_t len, bool shrink_after, float)
 	{
-		std::string utf8_str;
-		utf8_str.reserve(len * reserve_ratio);
-
-		char utf8_buf[4] = { 0, 0, 0, 0 };
-
-		auto push = [&](size_t len)
-		{
-			utf8_str.append((char*)utf8_buf, len);
-			((char32_t*)utf8_buf)[0] = 0;
-		};
-
-		for (int i = 0; i < len; i++)
-		{
-			if (!(utf32_str[i] >= 0xD800 && utf32_str[i] <= 0xDFFF) && utf32_str[i] <= 0x10FFFF)
-			{
-				if (utf32_str[i] < (1 << 7))
-				{
-					utf8_buf[0] = utf32_str[i];
-					push(1);
-				}
-				else if (utf32_str[i] < (1 << 11))
-				{
-					utf8_buf[0] = (utf32_str[i] >> 6) | 0b11000000;
-					utf8_buf[1] = (utf32_str[i] & 0b00111111) | 0b10000000;
-					push(2);
-				}
-				else if (utf32_str[i] < (1 << 16))
-				{
-					utf8_buf[0] = (utf32_str[i] >> 12) | 0b11100000;
-					utf8_buf[1] = ((utf32_str[i] >> 6) & 0b00111111) | 0b10000000;
-					utf8_buf[2] = (utf32_str[i] & 0b00111111) | 0b10000000;
-					push(3);
-				}
-				else
-				{
-					utf8_buf[0] = (utf32_str[i] >> 18) | 0b11110000;
-					utf8_buf[1] = ((utf32_str[i] >> 12) & 0b00111111) | 0b10000000;
-					utf8_buf[2] = ((utf32_str[i] >> 6) & 0b00111111) | 0b10000000;
-					utf8_buf[3] = (utf32_str[i] & 0b00111111) | 0b10000000;
-					push(4);
-				}
-			}
-			else
-			{
-				utf8_str.append("\xEF\xBF\xBD");
-			}
-
-		}
+		std::string utf8_str(len * 4, '\0');
+		utf8_str.resize(encodeUtf8(utf32_str, len, &utf8_str[0]));
 
 		if (shrink_after)
 		{
@@ -171,14 +292,11 @@ namespace tui
 		return utf32ToUtf8(utf32_str.data(), utf32_str.size(), shrink_after, reserve_ratio);
 	}
 
-	bool isBreakBetween(char32_t l, char32_t r)
+	bool isBreakBetween(GRAPHEME_TYPE l_t, GRAPHEME_TYPE r_t)
 	{
-		GRAPHEME_TYPE l_t = getGraphemeType(l);
-		GRAPHEME_TYPE r_t = getGraphemeType(r);
-
 		/*
 		http://www.unicode.org/reports/tr29/
-		This is not complete implementation of above(Regional_indicator is ommited)
+		GB11-GB13 depend on preceding code points, they are applied by grapheme_iterator::find()
 		*/
 
 		//GB3
@@ -247,6 +365,10 @@ namespace tui
 		//GB999
 		return true;
 	}
+	bool isBreakBetween(char32_t l, char32_t r)
+	{
+		return isBreakBetween(getGraphemeType(l), getGraphemeType(r));
+	}
 
 	bool isControl(char32_t cp)
 	{
@@ -255,33 +377,101 @@ namespace tui
 
 	bool isWide(char32_t cp)
 	{
-		struct range { unsigned int r_s, r_e; };
+		if (cp < 0x1100) { return false; }//first wide codepoint
+
+		return getProperties(cp) & WIDE_BIT;
+	}
+
+	bool isExtendedPictographic(char32_t cp)
+	{
+		return getProperties(cp) & PICTOGRAPHIC_BIT;
+	}
 
-		static const std::vector<range> ranges =
+	void grapheme_iterator::find()
+	{
+		const unsigned char* str = reinterpret_cast<const unsigned char*>(m_str);
+		const size_t begin = m_cluster.offset;
+
+		if (begin >= m_len)
 		{
-			#include "udata/wide_ranges.h"
-		};
+			m_cluster = { m_len, 0, 0, true };
+			return;
+		}
 
-		int s = 0;
-		int e = ranges.size() - 1;
+		//printable ascii followed by ascii is always single cluster
+		if (str[begin] >= 32 && str[begin] <= 126 && (begin + 1 == m_len || str[begin + 1] < 0x80))
+		{
+			m_cluster.length = 1;
+			m_cluster.width = 1;
+			m_cluster.valid = true;
+			return;
+		}
 
-		while (s <= e)
+		auto getWidth = [](uint8_t props) -> uint8_t
 		{
-			int c = (s + e) / 2;
+			if (props & WIDE_BIT) { return 2; }
+			return static_cast<GRAPHEME_TYPE>(props & GRAPHEME_TYPE_MASK) == GRAPHEME_TYPE::EXTEND ? 0 : 1;
+		};
 
-			if (ranges[c].r_s > cp)
-			{
-				e = --c;
-			}
-			else if (ranges[c].r_e < cp)
+		bool cp_valid = true;//validity of last decoded code point
+		auto decode = [&](size_t pos, size_t& length) -> char32_t
+		{
+			if (str[pos] < 0x80)
 			{
-				s = ++c;
+				cp_valid = true;
+				length = 1;
+				return str[pos];
 			}
-			else
+			char32_t cp;
+			const int l = decodeSequence(str + pos, m_len - pos, cp);
+			cp_valid = l > 0;
+			length = l > 0 ? l : -l;
+			return cp;
+		};
+
+		size_t length;
+		const char32_t first = decode(begin, length);
+		bool valid = cp_valid;
+		uint8_t props = getProperties(first);
+
+		GRAPHEME_TYPE prev_t = static_cast<GRAPHEME_TYPE>(props & GRAPHEME_TYPE_MASK);
+		bool pictographic = props & PICTOGRAPHIC_BIT;//Extended_Pictographic Extend* precedes
+		bool pictographic_zwj = false;//Extended_Pictographic Extend* ZWJ precedes
+		unsigned int ri_count = prev_t == GRAPHEME_TYPE::REGIONAL_INDICATOR;//preceding regional indicators
+
+		const bool control = isControl(first);
+		uint8_t width = control ? 0 : getWidth(props);
+
+		size_t end = begin + length;
+		while (end < m_len)
+		{
+			const char32_t cp = decode(end, length);
+			props = getProperties(cp);
+			const GRAPHEME_TYPE t = static_cast<GRAPHEME_TYPE>(props & GRAPHEME_TYPE_MASK);
+
+			if (isBreakBetween(prev_t, t))
 			{
-				return true;
+				//GB11
+				const bool emoji_zwj = pictographic_zwj && (props & PICTOGRAPHIC_BIT);
+				//GB12, GB13
+				const bool ri_pair = t == GRAPHEME_TYPE::REGIONAL_INDICATOR && ri_count % 2 == 1;
+
+				if (!emoji_zwj && !ri_pair) { break; }
 			}
+
+			pictographic_zwj = pictographic && t == GRAPHEME_TYPE::ZWJ;
+			pictographic = (props & PICTOGRAPHIC_BIT) || (pictographic && t == GRAPHEME_TYPE::EXTEND);
+			ri_count = t == GRAPHEME_TYPE::REGIONAL_INDICATOR ? ri_count + 1 : 0;
+
+			if (!control) { width = std::max(width, getWidth(props)); }
+
+			valid = valid && cp_valid;
+			prev_t = t;
+			end += length;
 		}
-		return false;
+
+		m_cluster.length = end - begin;
+		m_cluster.width = width;
+		m_cluster.valid = valid;
 	}
 }
\ No newline at end of file
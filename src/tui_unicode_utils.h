@@ -1,5 +1,8 @@
 #pragma once
 #include <string>
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
 
 namespace tui
 {
@@ -23,15 +26,107 @@ namespace tui
 
 	GRAPHEME_TYPE getGraphemeType(char32_t grapheme);
 
-	std::u32string utf8ToUtf32(const std::string& utf8_str, bool shrink_after = true, float reserve_ratio = 0.5);
-	std::u32string utf8ToUtf32(const char* utf8_str, size_t len, bool shrink_after = true, float reserve_ratio = 0.5);
+	/*decodes len bytes into dst(has to have room for len code points), returns number of code points,
+	invalid sequences are replaced by U+FFFD, ascii runs are converted in blocks(SSE2/AVX2 if available)*/
+	size_t decodeUtf8(const char* utf8_str, size_t len, char32_t* dst);
+	//decodes first code point, sets its length in bytes, returns 0 if len is 0
+	char32_t decodeUtf8CodePoint(const char* utf8_str, size_t len, size_t& length);
+	//returns false on overlong forms, surrogates, code points above U+10FFFF and broken sequences
+	bool isValidUtf8(const char* utf8_str, size_t len);
 
-	std::string utf32ToUtf8(const std::u32string& utf32_str, bool shrink_after = true, float reserve_ratio = 2);
-	std::string utf32ToUtf8(const char32_t* utf32_str, size_t len, bool shrink_after = true, float reserve_ratio = 2);
+	//encodes len code points into dst(has to have room for 4 * len bytes), returns number of bytes
+	size_t encodeUtf8(const char32_t* utf32_str, size_t len, char* dst);
 
+	//reserve_ratio is ignored, result is sized from length of input
+	std::u32string utf8ToUtf32(const std::string& utf8_str, bool shrink_after = false, float reserve_ratio = 0.5);
+	std::u32string utf8ToUtf32(const char* utf8_str, size_t len, bool shrink_after = false, float reserve_ratio = 0.5);
+
+	std::string utf32ToUtf8(const std::u32string& utf32_str, bool shrink_after = false, float reserve_ratio = 2);
+	std::string utf32ToUtf8(const char32_t* utf32_str, size_t len, bool shrink_after = false, float reserve_ratio = 2);
+
+	/*rules depending only on pair of code points, regional indicator pairs and emoji zwj sequences
+	need preceding code points, grapheme_iterator handles them*/
 	bool isBreakBetween(char32_t l, char32_t r);
 
 	bool isControl(char32_t cp);
 
 	bool isWide(char32_t cp);
+
+	bool isExtendedPictographic(char32_t cp);
+
+	//grapheme cluster found by grapheme_iterator
+	struct grapheme_cluster
+	{
+		size_t offset;//in bytes
+		size_t length;//in bytes
+		uint8_t width;//number of columns
+		bool valid;//false if cluster contains invalid sequence(decoded as U+FFFD)
+	};
+
+	/*iterates over grapheme clusters of utf8 text(UAX #29 extended grapheme clusters),
+	text is not copied, invalid sequences are treated as U+FFFD*/
+	struct grapheme_iterator
+	{
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = grapheme_cluster;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const grapheme_cluster*;
+		using reference = const grapheme_cluster&;
+
+	private:
+		const char* m_str = nullptr;
+		size_t m_len = 0;
+		grapheme_cluster m_cluster = { 0, 0, 0, true };
+
+		//finds cluster starting at m_cluster.offset
+		void find();
+
+	public:
+		grapheme_iterator() {}
+		//offset has to be at the beginning of cluster
+		grapheme_iterator(const char* str, size_t len, size_t offset = 0) : m_str(str), m_len(len)
+		{
+			m_cluster.offset = offset;
+			find();
+		}
+
+		reference operator*() const { return m_cluster; }
+		pointer operator->() const { return &m_cluster; }
+
+		grapheme_iterator& operator++()
+		{
+			m_cluster.offset += m_cluster.length;
+			find();
+			return *this;
+		}
+		grapheme_iterator operator++(int)
+		{
+			grapheme_iterator tmp = *this;
+			++*this;
+			return tmp;
+		}
+
+		bool operator==(const grapheme_iterator& other) const { return m_str == other.m_str && m_cluster.offset == other.m_cluster.offset; }
+		bool operator!=(const grapheme_iterator& other) const { return !operator==(other); }
+	};
+
+	/*range of grapheme clusters, text has to outlive it
+	
+	for (const auto& c : grapheme_segmenter(str))
+	{
+		//str.substr(c.offset, c.length) occupies c.width columns
+	}*/
+	struct grapheme_segmenter
+	{
+	private:
+		const char* m_str;
+		size_t m_len;
+
+	public:
+		grapheme_segmenter(const char* str, size_t len) : m_str(str), m_len(len) {}
+		grapheme_segmenter(const std::string& str) : m_str(str.data()), m_len(str.size()) {}
+
+		grapheme_iterator begin() const { return grapheme_iterator(m_str, m_len); }
+		grapheme_iterator end() const { return grapheme_iterator(m_str, m_len, m_len); }
+	};
 }
\ No newline at end of file
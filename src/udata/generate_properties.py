@@ -0,0 +1,49 @@
+#generates properties.h (two-stage lookup tables) from grapheme_ranges.h, wide_ranges.h and extended_pictographic_ranges.h
+#usage: python3 generate_properties.py, run from this directory
+import re
+
+GRAPHEME_TYPES = ["OTHER", "CONTROL", "LF", "CR", "EXTEND", "PREPEND", "SPACINGMARK", "REGIONAL_INDICATOR",
+                  "L", "V", "T", "LV", "LVT", "ZWJ"]  # same order as GRAPHEME_TYPE
+WIDE_BIT = 0x10
+PICTOGRAPHIC_BIT = 0x20
+BLOCK = 256
+CP_COUNT = 0x110000
+
+props = bytearray(CP_COUNT)
+
+for m in re.finditer(r"\{\s*(0x[0-9A-Fa-f]+)\s*,\s*(0x[0-9A-Fa-f]+)\s*,\s*GRAPHEME_TYPE::(\w+)\s*\}", open("grapheme_ranges.h").read()):
+    t = GRAPHEME_TYPES.index(m.group(3))
+    for cp in range(int(m.group(1), 16), int(m.group(2), 16) + 1):
+        props[cp] = (props[cp] & ~0xF) | t
+
+for m in re.finditer(r"\{\s*(0x[0-9A-Fa-f]+)\s*,\s*(0x[0-9A-Fa-f]+)\s*\}", open("wide_ranges.h").read()):
+    for cp in range(int(m.group(1), 16), int(m.group(2), 16) + 1):
+        props[cp] |= WIDE_BIT
+
+for m in re.finditer(r"\{\s*(0x[0-9A-Fa-f]+)\s*,\s*(0x[0-9A-Fa-f]+)\s*\}", open("extended_pictographic_ranges.h").read()):
+    for cp in range(int(m.group(1), 16), int(m.group(2), 16) + 1):
+        props[cp] |= PICTOGRAPHIC_BIT
+
+blocks = []
+block_idx = {}
+stage1 = []
+for b in range(0, CP_COUNT, BLOCK):
+    block = bytes(props[b:b + BLOCK])
+    if block not in block_idx:
+        block_idx[block] = len(blocks)
+        blocks.append(block)
+    stage1.append(block_idx[block])
+
+assert len(blocks) <= 256
+
+def rows(values, per_row):
+    return ",\n".join("\t" + ", ".join(str(v) for v in values[i:i + per_row]) for i in range(0, len(values), per_row))
+
+with open("properties.h", "w") as f:
+    f.write("//generated by generate_properties.py from grapheme_ranges.h, wide_ranges.h and extended_pictographic_ranges.h, do not edit\n")
+    f.write("//index of block of %d codepoints in properties_stage2\n" % BLOCK)
+    f.write("constexpr uint8_t properties_stage1[%d] =\n{\n%s\n};\n" % (len(stage1), rows(stage1, 32)))
+    f.write("//bits 0-3 - GRAPHEME_TYPE, bit 4 - wide, bit 5 - Extended_Pictographic\n")
+    f.write("constexpr uint8_t properties_stage2[%d][%d] =\n{\n" % (len(blocks), BLOCK))
+    f.write(",\n".join("\t{\n" + rows(list(b), 32).replace("\n\t", "\n\t\t").replace("\t", "\t\t", 1) + "\n\t}" for b in blocks))
+    f.write("\n};")